@@ -0,0 +1,851 @@
+#include "include/analysis/costAnalysis.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include "include/searchEngine/groupSearchEngine.h"
+#include "include/searchEngine/tileSearchEngine.h"
+#include "include/searchEngine/transformSearchEngine.h"
+#include "include/util/config.h"
+#include "include/util/debug.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+long long DSE::TransformSearchEngine::totalCount = 0;
+long long DSE::GroupSearchEngine::totalCount = 0;
+long long DSE::MultiLevelTransformSearchEngine::_resultCount = 0;
+extern COST::COSTDADA _Cost;
+
+// random mappings are analyzed twice: by a MultLevelAnalyzer reused across
+// the steps of a case the way the search reuses it, with its unchanged T
+// skip and sub level cache, and by a new one without the sub level cache for
+// every step. every field of the results of every level must be equal.
+// --record writes the results of the new analyzers to a file which --check
+// compares a later build against, freezing the analyzer of the recording
+// build as the reference. --replay runs the cases of such a file without its
+// results, with --record another build records its own results for them.
+// bench/analyzerDiffReference.txt holds the results of the analyzer before
+// the reuse, see its commit
+
+// fixed tasks and accelerators, independent of the config. the tasks are
+// small enough for every level to enumerate its transform matrices quickly
+void defineDiffGemm(Task &task) {
+  auto i = task.defineIterator(12, "i");
+  auto j = task.defineIterator(10, "j");
+  auto k = task.defineIterator(20, "k");
+
+  task.defineTensor(ARCH::INPUT, "I", {i, k});
+  task.defineTensor(ARCH::WEIGHT, "W", {k, j});
+  task.defineTensor(ARCH::OUTPUT, "O", {i, j});
+}
+
+void defineDiffConv1D(Task &task) {
+  auto k = task.defineIterator(8, "k");
+  auto c = task.defineIterator(6, "c");
+  auto w = task.defineIterator(14, "w");
+  auto s = task.defineIterator(3, "s");
+
+  task.defineTensor(ARCH::INPUT, "I", {c, w + s});
+  task.defineTensor(ARCH::WEIGHT, "W", {k, c, s});
+  task.defineTensor(ARCH::OUTPUT, "O", {k, w});
+}
+
+const int diffTaskNum = 2;
+
+void defineDiffTask(Task &task, int taskIndex) {
+  if (taskIndex == 0)
+    defineDiffGemm(task);
+  else
+    defineDiffConv1D(task);
+}
+
+void defineDiffAccelerator(AcceleratorSet &accSet, int row, int col,
+                           long long capacity) {
+  Accelerator acc;
+  acc.setDataWidth(16);
+
+  acc.addLevel(row, col, false, true);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::INPUT, 256000000, capacity);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::WEIGHT, 256000000, capacity);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::OUTPUT, 256000000, capacity);
+  acc.addNetworkGroup(0, ARCH::INPUT, {{1, 0, 0}});
+  acc.addNetworkGroup(0, ARCH::WEIGHT, {{0, 0, 1}});
+  acc.addNetworkGroup(0, ARCH::OUTPUT, {{0, 1, 0}});
+
+  accSet.addAcc(acc);
+}
+
+// two levels of 2x2 arrays, the upper one is analyzed over the results of
+// the lower one, which the sub level cache keeps across the steps. unicast
+// networks accept every reuse, leaving many transform matrices per level
+void defineDiffTwoLevelAccelerator(AcceleratorSet &accSet) {
+  Accelerator acc;
+  acc.setDataWidth(16);
+
+  for (int i = 0; i < 2; i++) {
+    acc.addLevel(2, 2, i == 0, true);
+    acc.addBuffer(i, ARCH::SRAM, ARCH::INPUT, 256000000, 12800000000);
+    acc.addBuffer(i, ARCH::SRAM, ARCH::WEIGHT, 256000000, 12800000000);
+    acc.addBuffer(i, ARCH::SRAM, ARCH::OUTPUT, 256000000, 12800000000);
+    acc.addNetworkGroup(i, ARCH::INPUT, {{0, 0, 0}});
+    acc.addNetworkGroup(i, ARCH::WEIGHT, {{0, 0, 0}});
+    acc.addNetworkGroup(i, ARCH::OUTPUT, {{0, 0, 0}});
+  }
+
+  accSet.addAcc(acc);
+}
+
+// a 2x2 array under two rows of 2. generateCase puts an outer iterator with
+// an edge at least two levels above its inner part, whose ranges then change
+// below the sub level of the outer one
+void defineDiffThreeLevelAccelerator(AcceleratorSet &accSet) {
+  Accelerator acc;
+  acc.setDataWidth(16);
+
+  acc.addLevel(2, 2, true, true);
+  acc.addLevel(2, false, true);
+  acc.addLevel(2, false, true);
+  for (int i = 0; i < 3; i++) {
+    acc.addBuffer(i, ARCH::SRAM, ARCH::INPUT, 256000000, 12800000000);
+    acc.addBuffer(i, ARCH::SRAM, ARCH::WEIGHT, 256000000, 12800000000);
+    acc.addBuffer(i, ARCH::SRAM, ARCH::OUTPUT, 256000000, 12800000000);
+    acc.addNetworkGroup(i, ARCH::INPUT, {{0, 0, 0}});
+    acc.addNetworkGroup(i, ARCH::WEIGHT, {{0, 0, 0}});
+    acc.addNetworkGroup(i, ARCH::OUTPUT, {{0, 0, 0}});
+  }
+
+  accSet.addAcc(acc);
+}
+
+void defineDiffAcceleratorSet(AcceleratorSet &accSet) {
+  defineDiffAccelerator(accSet, 4, 4, 12800000000);
+  defineDiffAccelerator(accSet, 8, 8, 2048);
+  defineDiffTwoLevelAccelerator(accSet);
+  defineDiffThreeLevelAccelerator(accSet);
+}
+
+// --cases=N --steps=N --seed=N --record=file --check=file --replay=file
+// --output=file
+struct DiffOption {
+  int _caseNum;
+  int _stepNum;
+  unsigned int _seed;
+  std::string _recordName;
+  std::string _checkName;
+  std::string _replayName;
+  std::string _output;
+  DiffOption()
+      : _caseNum(100), _stepNum(8), _seed(0),
+        _output("analyzer_diff_result.json") {}
+};
+
+void parseDiffOption(int argc, char **argv, DiffOption &option) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string key = arg.substr(0, arg.find('='));
+    std::string value =
+        arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+    if (key == "--cases" && !value.empty()) {
+      option._caseNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._caseNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--steps" && !value.empty()) {
+      option._stepNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._stepNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--seed" && !value.empty()) {
+      option._seed = parseIntegerOption(arg, value, 0, UINT_MAX);
+    } else if (key == "--record" && !value.empty()) {
+      option._recordName = value;
+    } else if (key == "--check" && !value.empty()) {
+      option._checkName = value;
+    } else if (key == "--replay" && !value.empty()) {
+      option._replayName = value;
+    } else if (key == "--output" && !value.empty()) {
+      option._output = value;
+    } else {
+      DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    }
+  }
+  DEBUG::check(option._recordName.empty() || option._checkName.empty(),
+               DEBUG::ERROR_OPTION, "--record and --check");
+  DEBUG::check(option._checkName.empty() || option._replayName.empty(),
+               DEBUG::ERROR_OPTION, "--check and --replay");
+}
+
+// one mapping per step on the same tiling and grouping. the transform
+// indices are taken modulo the transform matrices of their level, which
+// keeps a case valid while it is shrunk. a negative index -1 - r is the r-th
+// transform matrix of the level before the constraint check, which may be
+// rejected
+struct DiffCase {
+  int taskIndex;
+  int accIndex;
+  // tile size of every iterator of the task, its range for no split
+  std::vector<int> tileVec;
+  // level of every iterator after the splits
+  std::vector<int> groupVec;
+  // transform index of every level of every step
+  std::vector<std::vector<long long>> stepVec;
+
+  std::string toString() {
+    std::ostringstream os;
+    os << "task " << taskIndex << " acc " << accIndex << " tile "
+       << tileVec.size();
+    for (auto size : tileVec)
+      os << ' ' << size;
+    os << " group " << groupVec.size();
+    for (auto level : groupVec)
+      os << ' ' << level;
+    os << " steps " << stepVec.size();
+    for (auto &step : stepVec) {
+      os << ' ' << step.size();
+      for (auto index : step)
+        os << ' ' << index;
+    }
+    return os.str();
+  }
+
+  bool parse(std::string line) {
+    std::istringstream is(line);
+    std::string word;
+    int num;
+    is >> word >> taskIndex;
+    if (word != "task" || taskIndex < 0 || taskIndex >= diffTaskNum)
+      return false;
+    is >> word >> accIndex >> word >> num;
+    tileVec = std::vector<int>(num);
+    for (auto &size : tileVec)
+      is >> size;
+    is >> word >> num;
+    groupVec = std::vector<int>(num);
+    for (auto &level : groupVec)
+      is >> level;
+    is >> word >> num;
+    stepVec = std::vector<std::vector<long long>>(num);
+    for (auto &step : stepVec) {
+      is >> num;
+      step = std::vector<long long>(num);
+      for (auto &index : step)
+        is >> index;
+    }
+    return !is.fail();
+  }
+};
+
+// every field of the results of every level as "name=value" words, doubles
+// with all their digits so that equal strings mean equal results
+class ResultWriter {
+  std::ostringstream _os;
+
+public:
+  void add(std::string name, long long value) {
+    _os << name << '=' << value << ' ';
+  }
+  void add(std::string name, double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    _os << name << '=' << buf << ' ';
+  }
+  void add(std::string name, long long *value, int num) {
+    for (int i = 0; i < num; i++)
+      add(name + std::to_string(i), value[i]);
+  }
+  void add(std::string name, double *value, int num) {
+    for (int i = 0; i < num; i++)
+      add(name + std::to_string(i), value[i]);
+  }
+  void add(std::string name,
+           std::shared_ptr<std::map<std::pair<int, int>, long long>> map) {
+    _os << name << '=';
+    for (auto &p : *map)
+      _os << '(' << p.first.first << ',' << p.first.second << "):"
+          << p.second << ',';
+    _os << ' ';
+  }
+  void addResult(std::string prefix, AnalyzerResult &r) {
+    add(prefix + "uniqueVolumn", r.uniqueVolumn, 3);
+    add(prefix + "totalVolumn", r.totalVolumn, 3);
+    add(prefix + "reuseVolumn", r.reuseVolumn, 3);
+    add(prefix + "requiredDataSize", r.requiredDataSize, 3);
+    add(prefix + "initDelay", r.initDelay, 3);
+    add(prefix + "initTimes", r.initTimes);
+    add(prefix + "stableDelay", r.stableDelay, 4);
+    add(prefix + "delay", r.delay);
+    add(prefix + "compCycle", r.compCycle);
+    add(prefix + "occTimes", r.occTimes);
+    add(prefix + "compRate", r.compRate);
+    add(prefix + "activePEMultTimeNum", r.activePEMultTimeNum);
+    add(prefix + "totalPEMultTimeNum", r.totalPEMultTimeNum);
+    add(prefix + "PEUtilRate", r.PEUtilRate);
+    add(prefix + "totalBandWidth", r.totalBandWidth, 3);
+    add(prefix + "requiredBandWidth", r.requiredBandWidth, 3);
+    for (int i = 0; i < 3; i++)
+      add(prefix + "activateCountMap" + std::to_string(i),
+          r.activateCountMapVec[i]);
+    add(prefix + "toSubVolumn", r.toSubVolumn, 3);
+    add(prefix + "bufferSubAccessEnergy", r.bufferSubAccessEnergy, 3);
+    add(prefix + "bufferUpAccessEnergy", r.bufferUpAccessEnergy, 3);
+    add(prefix + "accumulateEnergy", r.accumulateEnergy);
+    add(prefix + "networkEnergy", r.networkEnergy, 3);
+    add(prefix + "innerMostRegWriteEnergy", r.innerMostRegWriteEnergy);
+    add(prefix + "innerMostRegReadEnergy", r.innerMostRegReadEnergy);
+    add(prefix + "macEnergy", r.macEnergy);
+    add(prefix + "bufferArea", r.bufferArea, 3);
+    add(prefix + "networkArea", r.networkArea, 3);
+    add(prefix + "macArea", r.macArea);
+    add(prefix + "accumulateArea", r.accumulateArea);
+    add(prefix + "innerMostRegArea", r.innerMostRegArea);
+    add(prefix + "bufferLeakagePower", r.bufferLeakagePower, 3);
+    add(prefix + "networkLeakagePower", r.networkLeakagePower, 3);
+    add(prefix + "macLeakagePower", r.macLeakagePower);
+    add(prefix + "accumulateLeakagePower", r.accumulateLeakagePower);
+    add(prefix + "innerMostRegLeakagePower", r.innerMostRegLeakagePower);
+  }
+  std::string str() { return _os.str(); }
+};
+
+std::string serializeAnalyzer(MultLevelAnalyzer &multanalysis, int levelNum) {
+  if (!multanalysis.constraintCheck())
+    return "invalid";
+  ResultWriter writer;
+  for (int i = 0; i < levelNum; i++)
+    writer.addResult("L" + std::to_string(i) + ".",
+                     *multanalysis.getLevelResult(i));
+  return writer.str();
+}
+
+// first word two serialized results differ in
+void compFirstDiff(std::string reference, std::string optimized,
+                   std::string &referenceWord, std::string &optimizedWord) {
+  std::istringstream is1(reference), is2(optimized);
+  while (true) {
+    referenceWord.clear();
+    optimizedWord.clear();
+    is1 >> referenceWord;
+    is2 >> optimizedWord;
+    if (referenceWord != optimizedWord ||
+        (referenceWord.empty() && optimizedWord.empty()))
+      return;
+  }
+}
+
+// the tiling, grouping and transform matrices of a case, built as
+// TileSearchEngine, GroupSearchEngine and MultiLevelTransformSearchEngine
+// build them
+class DiffRunner {
+  Task _task;
+  Accelerator &_acc;
+  std::shared_ptr<DSE::TileSearchEngine> _tileSearchEngine;
+  std::vector<ARCH::Level> _LVec;
+  std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+      _coupledVarVecVec;
+  std::vector<DSE::TransformSearchEngine> _transformSearchEngineSet;
+  // every transform matrix of a level in the order of its permutations,
+  // generated on the first use
+  std::vector<std::vector<MAPPING::Transform>> _rawTVecVec;
+  // the optimized path, reused by every step
+  std::shared_ptr<MultLevelAnalyzer> _multanalysis;
+  std::vector<MultLevelAnalyzer> _multanalysisVec;
+
+  void addLevel(MultLevelAnalyzer &multanalysis) {
+    for (auto &transformSearchEngine : _transformSearchEngineSet)
+      transformSearchEngine.addLevel(multanalysis);
+  }
+  // the extended copy of a raw transform matrix is checked as
+  // generateAllTransformMatrix checks it
+  bool changeRawT(MultLevelAnalyzer &multanalysis, int level, long long index,
+                  MAPPING::Transform &T) {
+    auto &rawTVec = getRawTVec(level);
+    T.deepCopy(rawTVec[index % rawTVec.size()]);
+    return multanalysis.changeT(level, _coupledVarVecVec[level],
+                                _LVec[level].getSpatialDimNum(), T, true);
+  }
+  void changeT(MultLevelAnalyzer &multanalysis, std::vector<long long> &step) {
+    int levelNum = _LVec.size();
+    for (int i = 0; i < levelNum; i++) {
+      if (step[i] < 0) {
+        MAPPING::Transform T(0);
+        changeRawT(multanalysis, i, -1 - step[i], T);
+        continue;
+      }
+      auto &transformSearchEngine = _transformSearchEngineSet[i];
+      transformSearchEngine.setIndex(step[i] %
+                                     transformSearchEngine.getTNum());
+      transformSearchEngine.changeT(i, multanalysis);
+    }
+  }
+
+public:
+  DiffRunner(int taskIndex, Accelerator &acc) : _acc(acc) {
+    defineDiffTask(_task, taskIndex);
+    _tileSearchEngine = std::make_shared<DSE::TileSearchEngine>(
+        _task._tensorMap[ARCH::INPUT], _task._tensorMap[ARCH::WEIGHT],
+        _task._tensorMap[ARCH::OUTPUT], _task._coupledVarVec);
+    for (auto &L : acc._LVec)
+      _LVec.push_back(L.clone());
+  }
+  Task &getTask() { return _task; }
+  std::vector<ARCH::Level> &getLevelVec() { return _LVec; }
+
+  // the iterators after the splits
+  int split(std::vector<int> &tileVec) {
+    int num = _task._coupledVarVec.size();
+    for (int i = 0; i < num; i++)
+      _tileSearchEngine->split(_task._coupledVarVec[i], tileVec[i]);
+    return _tileSearchEngine->getCoupledVarVec().size();
+  }
+
+  // false if the grouping leaves a level fewer iterators than its spatial
+  // dims, overflows a buffer or a level has no transform matrix
+  bool setup(DiffCase &diffCase) {
+    auto &varVec = _tileSearchEngine->getCoupledVarVec();
+    int levelNum = _LVec.size();
+    if (diffCase.groupVec.size() != varVec.size())
+      return false;
+    _coupledVarVecVec =
+        std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>(
+            levelNum);
+    _rawTVecVec = std::vector<std::vector<MAPPING::Transform>>(levelNum);
+    for (int i = 0; i < varVec.size(); i++) {
+      int level = diffCase.groupVec[i];
+      if (level < 0 || level >= levelNum)
+        return false;
+      _coupledVarVecVec[level].push_back(varVec[i]);
+    }
+    int countCoupledVar = 0;
+    for (int i = 0; i < levelNum; i++) {
+      if (_coupledVarVecVec[i].size() <
+          std::max(1, _LVec[i].getSpatialDimNum()))
+        return false;
+      _transformSearchEngineSet.emplace_back(_coupledVarVecVec[i], _LVec[i],
+                                             _LVec[i].getSpatialDimNum(),
+                                             countCoupledVar);
+      countCoupledVar += _coupledVarVecVec[i].size();
+    }
+
+    auto &I = _tileSearchEngine->getI();
+    auto &W = _tileSearchEngine->getW();
+    auto &O = _tileSearchEngine->getO();
+    _multanalysis = std::make_shared<MultLevelAnalyzer>(I, W, O);
+    _multanalysisVec.emplace_back(I, W, O);
+    addLevel(*_multanalysis);
+    addLevel(_multanalysisVec[0]);
+    if (!_multanalysis->checkRequiredDataSize())
+      return false;
+    for (int i = 0; i < levelNum; i++) {
+      auto &transformSearchEngine = _transformSearchEngineSet[i];
+      transformSearchEngine.generateAllTransformMatrix(i, *_multanalysis,
+                                                       _multanalysisVec);
+      if (transformSearchEngine.isEmpty())
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<MAPPING::Transform> &getRawTVec(int level) {
+    auto &rawTVec = _rawTVecVec[level];
+    if (!rawTVec.empty())
+      return rawTVec;
+    int dimNum = _coupledVarVecVec[level].size();
+    std::vector<int> permute(dimNum);
+    std::iota(permute.begin(), permute.end(), 0);
+    std::vector<MAPPING::Transform> TVecTmp;
+    do {
+      DSE::TransformSearchEngine::generateTransformMatrix(
+          dimNum, _LVec[level].getSpatialDimNum(), permute, TVecTmp);
+      rawTVec.insert(rawTVec.end(), TVecTmp.begin(), TVecTmp.end());
+      TVecTmp.clear();
+    } while (std::next_permutation(permute.begin(), permute.end()));
+    return rawTVec;
+  }
+
+  // the funnel counter of the raw transform matrix, TRANSFORM if it passes
+  // the constraint check, and its PE rows. on a pooled analyzer the steps do
+  // not use
+  FUNNEL::Counter checkRawT(int level, long long index,
+                            std::vector<MAPPING::mappingValueType> &PERowVec) {
+    MAPPING::Transform T(0);
+    bool ret = changeRawT(_multanalysisVec[0], level, index, T);
+    PERowVec.assign(T.getMatrix()->begin(),
+                    T.getMatrix()->begin() + 2 * T.getColNum());
+    return ret ? FUNNEL::TRANSFORM
+               : _multanalysisVec[0].getRejectCounter(level);
+  }
+
+  std::string runOptimized(std::vector<long long> &step) {
+    changeT(*_multanalysis, step);
+    _multanalysis->oneAnalysis();
+    return serializeAnalyzer(*_multanalysis, _LVec.size());
+  }
+
+  // a new analyzer sees nothing of the steps before and, without the sub
+  // level cache, nothing of the edge states before
+  std::string runReference(std::vector<long long> &step) {
+    MultLevelAnalyzer multanalysis(_tileSearchEngine->getI(),
+                                   _tileSearchEngine->getW(),
+                                   _tileSearchEngine->getO());
+    multanalysis.setSubLevelCacheFlag(false);
+    addLevel(multanalysis);
+    multanalysis.checkRequiredDataSize();
+    changeT(multanalysis, step);
+    multanalysis.oneAnalysis();
+    return serializeAnalyzer(multanalysis, _LVec.size());
+  }
+};
+
+// three more steps at a random level: a valid T, a T of other PE rows
+// rejected while splitting its PE iterators and a valid T of the first PE
+// rows. the failed split must not leave the third T on the split of the
+// first. no steps if the level has no such pair of PE rows
+void addRejectedSteps(std::mt19937 &rng, DiffRunner &runner,
+                      DiffCase &diffCase) {
+  int level = rng() % runner.getLevelVec().size();
+  long long rawTNum = runner.getRawTVec(level).size();
+  std::map<std::vector<MAPPING::mappingValueType>, std::vector<long long>>
+      validMap, rejectedMap;
+  std::vector<MAPPING::mappingValueType> PERowVec;
+  for (long long i = 0; i < rawTNum; i++) {
+    FUNNEL::Counter counter = runner.checkRawT(level, i, PERowVec);
+    if (counter == FUNNEL::TRANSFORM)
+      validMap[PERowVec].push_back(i);
+    else if (counter == FUNNEL::TRANSFORM_REJECT_PE)
+      rejectedMap[PERowVec].push_back(i);
+  }
+  // the valid T's of some PE rows and a rejected T of other PE rows
+  std::vector<std::pair<std::vector<long long> *, long long>> pairVec;
+  for (auto &valid : validMap) {
+    for (auto &rejected : rejectedMap) {
+      if (rejected.first == valid.first)
+        continue;
+      for (auto index : rejected.second)
+        pairVec.emplace_back(&valid.second, index);
+    }
+  }
+  if (pairVec.empty())
+    return;
+  auto pair = pairVec[rng() % pairVec.size()];
+  auto &validVec = *pair.first;
+  long long first = validVec[rng() % validVec.size()];
+  long long third = validVec[rng() % validVec.size()];
+  for (auto index : {first, pair.second, third}) {
+    std::vector<long long> step = diffCase.stepVec.back();
+    step[level] = -1 - index;
+    diffCase.stepVec.push_back(step);
+  }
+}
+
+// true if the outer iterator of a split with an edge is at least two levels
+// above its inner part
+bool checkFarEdge(DiffCase &diffCase,
+                  std::vector<std::shared_ptr<WORKLOAD::Iterator>> &varVec) {
+  int varNum = varVec.size();
+  int outerIndex = varNum;
+  for (int i = 0; i < varNum; i++) {
+    int range = varVec[i]->getUpBound() - varVec[i]->getLowBound() + 1;
+    if (diffCase.tileVec[i] == range)
+      continue;
+    if (range % diffCase.tileVec[i] != 0 &&
+        diffCase.groupVec[outerIndex] >= diffCase.groupVec[i] + 2)
+      return true;
+    outerIndex++;
+  }
+  return false;
+}
+
+// a random tiling of at most 6 iterators, a random grouping that gives
+// every level its spatial dims and random transform indices. the tiling and
+// grouping are drawn again until every level has transform matrices and, on
+// three levels, checkFarEdge holds, the task and accelerator only after many
+// tries. the lower levels keep their T across half of the steps, which the
+// sub level cache of the optimized path reuses. a quarter of the cases end on
+// addRejectedSteps
+void generateCase(std::mt19937 &rng, AcceleratorSet &accSet, int stepNum,
+                  DiffCase &diffCase) {
+  for (int tryNum = 0;; tryNum++) {
+    if (tryNum % 100 == 0) {
+      diffCase.taskIndex = rng() % diffTaskNum;
+      diffCase.accIndex = rng() % accSet.acceleratorVec.size();
+    }
+    Accelerator &acc = accSet.acceleratorVec[diffCase.accIndex];
+    DiffRunner runner(diffCase.taskIndex, acc);
+    auto &varVec = runner.getTask()._coupledVarVec;
+    int varNum = varVec.size();
+    diffCase.tileVec.clear();
+    for (auto &var : varVec) {
+      int range = var->getUpBound() - var->getLowBound() + 1;
+      if (varNum < 6 && range > 2 && rng() % 2 == 0) {
+        diffCase.tileVec.push_back(2 + rng() % (range - 2));
+        varNum++;
+      } else {
+        diffCase.tileVec.push_back(range);
+      }
+    }
+    varNum = runner.split(diffCase.tileVec);
+
+    auto &LVec = runner.getLevelVec();
+    int levelNum = LVec.size();
+    std::vector<int> order(varNum);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    diffCase.groupVec = std::vector<int>(varNum, levelNum - 1);
+    int index = 0;
+    for (int i = 0; i < levelNum; i++) {
+      int num = std::max(1, LVec[i].getSpatialDimNum());
+      for (int j = 0; j < num && index < varNum; j++)
+        diffCase.groupVec[order[index++]] = i;
+    }
+    for (; index < varNum; index++)
+      diffCase.groupVec[order[index]] = rng() % levelNum;
+    if (levelNum >= 3 && !checkFarEdge(diffCase, varVec))
+      continue;
+    if (!runner.setup(diffCase))
+      continue;
+
+    diffCase.stepVec.clear();
+    for (int i = 0; i < stepNum; i++) {
+      std::vector<long long> step;
+      for (int j = 0; j < levelNum; j++) {
+        if (i > 0 && j < levelNum - 1 && rng() % 2 == 0)
+          step.push_back(diffCase.stepVec[i - 1][j]);
+        else
+          step.push_back(rng() % 1000000);
+      }
+      diffCase.stepVec.push_back(step);
+    }
+    if (rng() % 4 == 0)
+      addRejectedSteps(rng, runner, diffCase);
+    return;
+  }
+}
+
+enum CaseStatus { CASE_SKIPPED, CASE_PASSED, CASE_FAILED };
+
+struct Mismatch {
+  int caseIndex;
+  int stepIndex;
+  std::string referenceWord;
+  std::string optimizedWord;
+  // the case cut after the mismatching step and shrunk
+  std::string reproducer;
+};
+
+// the results of every step of both paths, compared with the recorded ones
+// of the reference if any. returns the first mismatching step in stepIndex
+CaseStatus runCase(DiffCase &diffCase, AcceleratorSet &accSet,
+                   std::vector<std::string> *recordVec,
+                   std::vector<std::string> &referenceVec, int &stepIndex,
+                   std::string &referenceWord, std::string &optimizedWord) {
+  if (diffCase.accIndex < 0 ||
+      diffCase.accIndex >= accSet.acceleratorVec.size())
+    return CASE_SKIPPED;
+  DiffRunner runner(diffCase.taskIndex,
+                    accSet.acceleratorVec[diffCase.accIndex]);
+  if (diffCase.tileVec.size() != runner.getTask()._coupledVarVec.size())
+    return CASE_SKIPPED;
+  runner.split(diffCase.tileVec);
+  if (!runner.setup(diffCase))
+    return CASE_SKIPPED;
+  referenceVec.clear();
+  for (stepIndex = 0; stepIndex < diffCase.stepVec.size(); stepIndex++) {
+    auto &step = diffCase.stepVec[stepIndex];
+    if (step.size() != runner.getLevelVec().size())
+      return CASE_SKIPPED;
+    std::string optimized = runner.runOptimized(step);
+    std::string reference = runner.runReference(step);
+    referenceVec.push_back(reference);
+    std::string expected = reference;
+    if (recordVec != nullptr && stepIndex < recordVec->size())
+      expected = (*recordVec)[stepIndex];
+    for (auto result : {reference, optimized}) {
+      if (result != expected) {
+        compFirstDiff(expected, result, referenceWord, optimizedWord);
+        return CASE_FAILED;
+      }
+    }
+  }
+  return CASE_PASSED;
+}
+
+// a failing case is cut after its first mismatching step, then steps, tile
+// splits and transform indices are dropped one at a time as long as the two
+// paths still differ. a case that only differs from its recorded results is
+// just cut, the recorded reference of a changed case is unknown
+void shrinkCase(DiffCase &diffCase, AcceleratorSet &accSet, int stepIndex) {
+  diffCase.stepVec.resize(stepIndex + 1);
+  std::vector<std::string> referenceVec;
+  std::string referenceWord, optimizedWord;
+  auto checkFail = [&](DiffCase &candidate) {
+    int failStep;
+    if (runCase(candidate, accSet, nullptr, referenceVec, failStep,
+                referenceWord, optimizedWord) != CASE_FAILED)
+      return false;
+    candidate.stepVec.resize(failStep + 1);
+    return true;
+  };
+  if (!checkFail(diffCase))
+    return;
+  bool changeFlag = true;
+  while (changeFlag) {
+    changeFlag = false;
+    for (int i = 0; i < diffCase.stepVec.size() && diffCase.stepVec.size() > 1;
+         i++) {
+      DiffCase candidate = diffCase;
+      candidate.stepVec.erase(candidate.stepVec.begin() + i);
+      if (checkFail(candidate)) {
+        diffCase = candidate;
+        changeFlag = true;
+        i--;
+      }
+    }
+    // an unsplit iterator loses its outer iterator, which split appended
+    // after the original ones in the order of the splits
+    DiffRunner runner(diffCase.taskIndex,
+                      accSet.acceleratorVec[diffCase.accIndex]);
+    auto &varVec = runner.getTask()._coupledVarVec;
+    int varNum = varVec.size();
+    int outerIndex = varNum;
+    for (int i = 0; i < varNum; i++) {
+      int range = varVec[i]->getUpBound() - varVec[i]->getLowBound() + 1;
+      if (diffCase.tileVec[i] == range)
+        continue;
+      DiffCase candidate = diffCase;
+      candidate.tileVec[i] = range;
+      candidate.groupVec.erase(candidate.groupVec.begin() + outerIndex);
+      if (checkFail(candidate)) {
+        diffCase = candidate;
+        changeFlag = true;
+      } else {
+        outerIndex++;
+      }
+    }
+    for (int i = 0; i < diffCase.stepVec.size(); i++) {
+      for (int j = 0; j < diffCase.stepVec[i].size(); j++) {
+        if (diffCase.stepVec[i][j] == 0)
+          continue;
+        DiffCase candidate = diffCase;
+        candidate.stepVec[i][j] = 0;
+        if (checkFail(candidate)) {
+          diffCase = candidate;
+          changeFlag = true;
+        }
+      }
+    }
+  }
+}
+
+void readRecord(std::string name, std::vector<DiffCase> &caseVec,
+                std::vector<std::vector<std::string>> &recordVecVec) {
+  std::ifstream ifile;
+  ifile.open(name, std::ios::in);
+  DEBUG::check(ifile.is_open(), DEBUG::FILE_ERROR, name);
+  std::string line;
+  while (std::getline(ifile, line)) {
+    std::vector<std::string> fieldVec;
+    std::istringstream is(line);
+    std::string field;
+    while (std::getline(is, field, '\t'))
+      fieldVec.push_back(field);
+    DiffCase diffCase;
+    DEBUG::check(!fieldVec.empty() && diffCase.parse(fieldVec[0]),
+                 DEBUG::ERROR_OPTION, name + ": " + line);
+    caseVec.push_back(diffCase);
+    recordVecVec.emplace_back(fieldVec.begin() + 1, fieldVec.end());
+  }
+}
+
+void outputDiffResult(DiffOption &option, int caseNum, int skipNum,
+                      long long stepNum, std::vector<Mismatch> &mismatchVec) {
+  std::ofstream ofile;
+  ofile.open(option._output, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"seed\":" << option._seed << ",\n";
+  ofile << "\"cases\":" << caseNum << ",\n";
+  ofile << "\"skipped\":" << skipNum << ",\n";
+  ofile << "\"steps\":" << stepNum << ",\n";
+  ofile << "\"mismatches\":[\n";
+  for (int i = 0; i < mismatchVec.size(); i++) {
+    auto &m = mismatchVec[i];
+    ofile << "{\"case\":" << m.caseIndex << ",\"step\":" << m.stepIndex
+          << ",\"reference\":\"" << m.referenceWord << "\",\"optimized\":\""
+          << m.optimizedWord << "\",\"reproducer\":\"" << m.reproducer
+          << "\"}";
+    if (i != mismatchVec.size() - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "]\n}\n";
+  ofile.close();
+}
+
+int main(int argc, char **argv) {
+  DiffOption option;
+  parseDiffOption(argc, argv, option);
+  AcceleratorSet accSet;
+  defineDiffAcceleratorSet(accSet);
+
+  std::vector<DiffCase> caseVec;
+  std::vector<std::vector<std::string>> recordVecVec;
+  if (!option._checkName.empty()) {
+    readRecord(option._checkName, caseVec, recordVecVec);
+  } else if (!option._replayName.empty()) {
+    readRecord(option._replayName, caseVec, recordVecVec);
+    recordVecVec.clear();
+  } else {
+    std::mt19937 rng(option._seed);
+    for (int i = 0; i < option._caseNum; i++) {
+      caseVec.emplace_back();
+      generateCase(rng, accSet, option._stepNum, caseVec.back());
+    }
+  }
+  std::ofstream recordFile;
+  if (!option._recordName.empty())
+    recordFile.open(option._recordName, std::ios::out);
+
+  // generateAllTransformMatrix reports its threads on stdout
+  std::cout.setstate(std::ios::failbit);
+  int skipNum = 0;
+  long long stepNum = 0;
+  std::vector<Mismatch> mismatchVec;
+  for (int i = 0; i < caseVec.size(); i++) {
+    auto *recordVec = recordVecVec.empty() ? nullptr : &recordVecVec[i];
+    std::vector<std::string> referenceVec;
+    Mismatch m;
+    CaseStatus status =
+        runCase(caseVec[i], accSet, recordVec, referenceVec, m.stepIndex,
+                m.referenceWord, m.optimizedWord);
+    if (status == CASE_SKIPPED) {
+      skipNum++;
+      continue;
+    }
+    stepNum += referenceVec.size();
+    if (recordFile.is_open()) {
+      recordFile << caseVec[i].toString();
+      for (auto &reference : referenceVec)
+        recordFile << '\t' << reference;
+      recordFile << '\n';
+    }
+    if (status == CASE_FAILED) {
+      m.caseIndex = i;
+      DiffCase diffCase = caseVec[i];
+      shrinkCase(diffCase, accSet, m.stepIndex);
+      m.reproducer = diffCase.toString();
+      mismatchVec.push_back(m);
+    }
+  }
+  std::cout.clear();
+  recordFile.close();
+
+  std::cout << caseVec.size() << " cases, " << skipNum << " skipped, "
+            << stepNum << " steps, " << mismatchVec.size() << " mismatches"
+            << std::endl;
+  for (auto &m : mismatchVec)
+    std::cout << "case " << m.caseIndex << " step " << m.stepIndex
+              << ": reference " << m.referenceWord << " optimized "
+              << m.optimizedWord << "\n  reproducer: " << m.reproducer
+              << std::endl;
+  outputDiffResult(option, caseVec.size(), skipNum, stepNum, mismatchVec);
+  return mismatchVec.empty() ? 0 : 1;
+}
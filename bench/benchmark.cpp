@@ -0,0 +1,273 @@
+#include "include/analysis/costAnalysis.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include "include/searchEngine/groupSearchEngine.h"
+#include "include/searchEngine/tileSearchEngine.h"
+#include "include/searchEngine/transformSearchEngine.h"
+#include "include/util/config.h"
+#include "include/util/debug.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+long long DSE::TransformSearchEngine::totalCount = 0;
+long long DSE::GroupSearchEngine::totalCount = 0;
+long long DSE::MultiLevelTransformSearchEngine::_resultCount = 0;
+extern COST::COSTDADA _Cost;
+
+// fixed tasks and accelerators of the benchmark, independent of
+// defineTaskSet and defineAcceleratorSet so that editing the config does not
+// change what is measured
+
+// alexnet conv3
+void defineBenchConv(TaskSet &taskset) {
+  Task task;
+  auto k = task.defineIterator(384, "k");
+  auto c = task.defineIterator(256, "c");
+  auto h = task.defineIterator(13, "h");
+  auto w = task.defineIterator(13, "w");
+  auto r = task.defineIterator(3, "r");
+  auto s = task.defineIterator(3, "s");
+  auto n = task.defineIterator(64, "n");
+
+  task.defineTensor(ARCH::INPUT, "I", {n, c, h + r, w + s});
+  task.defineTensor(ARCH::WEIGHT, "W", {k, c, r, s});
+  task.defineTensor(ARCH::OUTPUT, "O", {n, k, h, w});
+
+  taskset.addTask(task);
+}
+
+// alexnet fc8
+void defineBenchFC(TaskSet &taskset) {
+  Task task;
+  auto i = task.defineIterator(64, "i", {8, 16});
+  auto j = task.defineIterator(1000, "j", {8, 125});
+  auto k = task.defineIterator(4096, "k", {16, 64, 256});
+
+  task.defineTensor(ARCH::INPUT, "I", {i, k});
+  task.defineTensor(ARCH::WEIGHT, "W", {k, j});
+  task.defineTensor(ARCH::OUTPUT, "O", {i, j});
+
+  taskset.addTask(task);
+}
+
+void defineBenchAccelerator(AcceleratorSet &accSet, int row, int col) {
+  Accelerator acc;
+  acc.setDataWidth(16);
+
+  acc.addLevel(row, col, false, true);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::INPUT, 256000000, 12800000000);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::WEIGHT, 256000000, 12800000000);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::OUTPUT, 256000000, 12800000000);
+  acc.addNetworkGroup(0, ARCH::INPUT, {{1, 0, 0}});
+  acc.addNetworkGroup(0, ARCH::WEIGHT, {{0, 0, 1}});
+  acc.addNetworkGroup(0, ARCH::OUTPUT, {{0, 1, 0}});
+
+  accSet.addAcc(acc);
+}
+
+struct BenchCase {
+  std::string name;
+  Task task;
+  Accelerator acc;
+};
+
+struct BenchResult {
+  std::string name;
+  std::vector<double> wallTimeVec;
+  long long evaluationNum;
+  long long resultNum;
+  double topScore;
+  unsigned long long checksum;
+};
+
+// --case=name --repeat=N --topk=N --output=file
+struct BenchOption {
+  std::string _caseName;
+  int _repeatNum;
+  int _topK;
+  std::string _output;
+  BenchOption() : _repeatNum(3), _topK(5), _output("bench_result.json") {}
+};
+
+void parseBenchOption(int argc, char **argv, BenchOption &option) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string key = arg.substr(0, arg.find('='));
+    std::string value =
+        arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+    if (key == "--case" && !value.empty()) {
+      option._caseName = value;
+    } else if (key == "--repeat" && !value.empty()) {
+      option._repeatNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._repeatNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--topk" && !value.empty()) {
+      option._topK = parseIntegerOption(arg, value);
+      DEBUG::check(option._topK > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--output" && !value.empty()) {
+      option._output = value;
+    } else {
+      DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    }
+  }
+}
+
+void defineBenchCase(std::vector<BenchCase> &caseVec) {
+  TaskSet taskSet;
+  defineBenchConv(taskSet);
+  defineBenchFC(taskSet);
+  AcceleratorSet accSet;
+  defineBenchAccelerator(accSet, 8, 8);
+  defineBenchAccelerator(accSet, 16, 16);
+  std::vector<std::string> taskNameVec = {"alexnet_conv3", "alexnet_fc8"};
+  std::vector<std::string> accNameVec = {"8x8", "16x16"};
+  for (int i = 0; i < taskSet.taskVec.size(); i++) {
+    for (int j = 0; j < accSet.acceleratorVec.size(); j++) {
+      caseVec.push_back({taskNameVec[i] + "_" + accNameVec[j],
+                         taskSet.taskVec[i], accSet.acceleratorVec[j]});
+    }
+  }
+}
+
+// fnv-1a over the bytes of a value
+void hashValue(unsigned long long &hash, const void *data, int size) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  for (int i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+// hash of the score, delay and unique volumns of every level of the topK
+// results, in the order of the score and then of the search
+unsigned long long
+compTopKChecksum(std::vector<std::shared_ptr<GroupSearchResult>> &resultVec,
+                 int topK) {
+  std::vector<std::shared_ptr<GroupSearchResult>> sortedVec(resultVec);
+  std::stable_sort(sortedVec.begin(), sortedVec.end(),
+                   [](const std::shared_ptr<GroupSearchResult> &r1,
+                      const std::shared_ptr<GroupSearchResult> &r2) {
+                     return r1->score < r2->score;
+                   });
+  unsigned long long hash = 14695981039346656037ULL;
+  int num = std::min(topK, int(sortedVec.size()));
+  for (int i = 0; i < num; i++) {
+    hashValue(hash, &sortedVec[i]->score, sizeof(double));
+    for (auto &levelResult : sortedVec[i]
+                                 ->_multiLevelTransformSearchResult
+                                 ->_transformSearchResult) {
+      auto &result = levelResult->_result;
+      hashValue(hash, &result->delay, sizeof(long long));
+      hashValue(hash, result->uniqueVolumn, sizeof(result->uniqueVolumn));
+    }
+  }
+  return hash;
+}
+
+void runBenchCase(BenchCase &benchCase, BenchOption &option,
+                  BenchResult &benchResult) {
+  benchResult.name = benchCase.name;
+  for (int i = 0; i < option._repeatNum; i++) {
+    Task task = benchCase.task;
+    DSE::TileSearchEngine tileSearchEngine(
+        task._tensorMap[ARCH::INPUT], task._tensorMap[ARCH::WEIGHT],
+        task._tensorMap[ARCH::OUTPUT], task._coupledVarVec);
+    for (auto &p : task._allIteratorCandidate) {
+      for (auto candidate : p.second) {
+        tileSearchEngine.addCancidate(p.first, candidate);
+      }
+    }
+    for (auto &L : benchCase.acc._LVec) {
+      ARCH::Level newL = L.clone();
+      tileSearchEngine.addLevel(newL);
+    }
+    Target target(benchCase.acc.getLevelNum());
+    target.addTarget(0, 9, 1);
+    tileSearchEngine.setTarget(target);
+
+    long long startCount = MultLevelAnalyzer::analysisCount;
+    // the search reports every tiling on stdout
+    std::cout.setstate(std::ios::failbit);
+    auto start = std::chrono::steady_clock::now();
+    tileSearchEngine.oneSearch();
+    auto end = std::chrono::steady_clock::now();
+    std::cout.clear();
+    benchResult.wallTimeVec.push_back(
+        std::chrono::duration<double>(end - start).count());
+    benchResult.evaluationNum = MultLevelAnalyzer::analysisCount - startCount;
+
+    tileSearchEngine.cmpScore(target);
+    std::vector<std::shared_ptr<GroupSearchResult>> resultVec;
+    tileSearchEngine.getResult(resultVec);
+    benchResult.resultNum = resultVec.size();
+    benchResult.topScore = tileSearchEngine.getTopScore();
+    benchResult.checksum = compTopKChecksum(resultVec, option._topK);
+  }
+}
+
+long long getPeakRSS() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+void outputBenchResult(std::vector<BenchResult> &benchResultVec,
+                       BenchOption &option, long long peakRSS) {
+  std::ofstream ofile;
+  ofile.open(option._output, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"repeat\":" << option._repeatNum << ",\n";
+  ofile << "\"topK\":" << option._topK << ",\n";
+  ofile << "\"peakRSSKB\":" << peakRSS << ",\n";
+  ofile << "\"cases\":[\n";
+  for (int i = 0; i < benchResultVec.size(); i++) {
+    auto &r = benchResultVec[i];
+    std::vector<double> timeVec(r.wallTimeVec);
+    std::sort(timeVec.begin(), timeVec.end());
+    double minTime = timeVec[0];
+    double medianTime = timeVec[timeVec.size() / 2];
+    char checksum[32];
+    snprintf(checksum, sizeof(checksum), "%016llx", r.checksum);
+    ofile << "{\"name\":\"" << r.name << "\",";
+    ofile << "\"wallTimeMin\":" << minTime << ",";
+    ofile << "\"wallTimeMedian\":" << medianTime << ",";
+    ofile << "\"evaluations\":" << r.evaluationNum << ",";
+    ofile << "\"evaluationsPerSec\":"
+          << (medianTime > 0 ? r.evaluationNum / medianTime : 0) << ",";
+    ofile << "\"results\":" << r.resultNum << ",";
+    ofile << "\"topScore\":" << r.topScore << ",";
+    ofile << "\"topKChecksum\":\"" << checksum << "\"}";
+    if (i != benchResultVec.size() - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "]\n}\n";
+  ofile.close();
+}
+
+int main(int argc, char **argv) {
+  BenchOption option;
+  parseBenchOption(argc, argv, option);
+  std::vector<BenchCase> caseVec;
+  defineBenchCase(caseVec);
+  std::vector<BenchResult> benchResultVec;
+  for (auto &benchCase : caseVec) {
+    if (!option._caseName.empty() && benchCase.name != option._caseName)
+      continue;
+    benchResultVec.emplace_back();
+    runBenchCase(benchCase, option, benchResultVec.back());
+    auto &r = benchResultVec.back();
+    std::cout << r.name << "\t" << r.wallTimeVec.back() << "s\t"
+              << r.evaluationNum << " evaluations" << std::endl;
+  }
+  DEBUG::check(!benchResultVec.empty(), DEBUG::ERROR_OPTION,
+               option._caseName);
+  outputBenchResult(benchResultVec, option, getPeakRSS());
+  std::cout << "peak rss: " << getPeakRSS() << "KB" << std::endl;
+  return 0;
+}
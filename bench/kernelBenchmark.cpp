@@ -0,0 +1,325 @@
+#include "include/analysis/costAnalysis.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include "include/analysis/singleLevelAnalysis.h"
+#include "include/searchEngine/groupSearchEngine.h"
+#include "include/searchEngine/tileSearchEngine.h"
+#include "include/searchEngine/transformSearchEngine.h"
+#include "include/util/config.h"
+#include "include/util/debug.h"
+#include "include/util/eigenUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+long long DSE::TransformSearchEngine::totalCount = 0;
+long long DSE::GroupSearchEngine::totalCount = 0;
+long long DSE::MultiLevelTransformSearchEngine::_resultCount = 0;
+extern COST::COSTDADA _Cost;
+
+// keeps the return value of a kernel alive
+volatile long long kernelSink;
+
+struct KernelResult {
+  std::string name;
+  long long iterNum;
+  double nsPerIter;
+};
+
+// --kernel=name --min-time=seconds --samples=N --output=file
+struct KernelOption {
+  std::string _kernelName;
+  double _minTime;
+  int _sampleNum;
+  std::string _output;
+  KernelOption()
+      : _minTime(0.2), _sampleNum(5), _output("kernel_bench_result.json") {}
+};
+
+void parseKernelOption(int argc, char **argv, KernelOption &option) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string key = arg.substr(0, arg.find('='));
+    std::string value =
+        arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+    if (key == "--kernel" && !value.empty()) {
+      option._kernelName = value;
+    } else if (key == "--min-time" && !value.empty()) {
+      option._minTime = parseDoubleOption(arg, value);
+      DEBUG::check(option._minTime > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--samples" && !value.empty()) {
+      option._sampleNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._sampleNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--output" && !value.empty()) {
+      option._output = value;
+    } else {
+      DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    }
+  }
+}
+
+// the iteration num is doubled until one sample takes minTime / sampleNum,
+// the fastest sample is reported
+KernelResult timeKernel(std::string name, KernelOption &option,
+                        std::function<long long()> kernel) {
+  double sampleTime = option._minTime / option._sampleNum;
+  long long iterNum = 1;
+  double elapsed = 0;
+  while (true) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterNum; i++)
+      kernelSink = kernel();
+    auto end = std::chrono::steady_clock::now();
+    elapsed = std::chrono::duration<double>(end - start).count();
+    if (elapsed >= sampleTime)
+      break;
+    iterNum *= 2;
+  }
+  double best = elapsed;
+  for (int s = 1; s < option._sampleNum; s++) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterNum; i++)
+      kernelSink = kernel();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  return {name, iterNum, best * 1e9 / iterNum};
+}
+
+// inputs of the kernels captured from one mapping of alexnet conv3 on an
+// 8x8 array: w is tiled by 5 which leaves an edge tile, k and c are the PE
+// dims and are split by the array
+class KernelBenchmark {
+private:
+  Task _task;
+  Accelerator _acc;
+  std::shared_ptr<DSE::TileSearchEngine> _tileSearchEngine;
+  std::shared_ptr<Analyzer> _analyzer;
+  std::vector<int> _innerTimeVec;
+  std::vector<int> _outerTimeVec;
+  std::vector<long long> _sramCapacityVec;
+  std::vector<double> _sramEnergyVec;
+  MAPPING::Transform _T8;
+  MAPPING::Access _A8;
+
+  void defineTask() {
+    auto k = _task.defineIterator(384, "k");
+    auto c = _task.defineIterator(256, "c");
+    auto h = _task.defineIterator(13, "h");
+    auto w = _task.defineIterator(13, "w");
+    auto r = _task.defineIterator(3, "r");
+    auto s = _task.defineIterator(3, "s");
+    auto n = _task.defineIterator(64, "n");
+
+    _task.defineTensor(ARCH::INPUT, "I", {n, c, h + r, w + s});
+    _task.defineTensor(ARCH::WEIGHT, "W", {k, c, r, s});
+    _task.defineTensor(ARCH::OUTPUT, "O", {n, k, h, w});
+  }
+
+  void defineAccelerator() {
+    _acc.setDataWidth(16);
+    _acc.addLevel(8, 8, false, true);
+    _acc.addBuffer(0, ARCH::SRAM, ARCH::INPUT, 256000000, 12800000000);
+    _acc.addBuffer(0, ARCH::SRAM, ARCH::WEIGHT, 256000000, 12800000000);
+    _acc.addBuffer(0, ARCH::SRAM, ARCH::OUTPUT, 256000000, 12800000000);
+    _acc.addNetworkGroup(0, ARCH::INPUT, {{1, 0, 0}});
+    _acc.addNetworkGroup(0, ARCH::WEIGHT, {{0, 0, 1}});
+    _acc.addNetworkGroup(0, ARCH::OUTPUT, {{0, 1, 0}});
+    _acc.check();
+  }
+
+  // k and c on the PE array, then n h w_i r s w_o from the innermost time,
+  // input is multicast along k, weight stationary over n and output
+  // reduced along c
+  MAPPING::Transform defineT(int varNum) {
+    std::vector<int> colVec = {0, 1, 6, 2, 3, 4, 5, 7};
+    MAPPING::Transform T(varNum);
+    for (int i = 0; i < varNum; i++)
+      T.setValue(i, colVec[i], 1);
+    return T;
+  }
+
+  // T is a permutation of a unit upper triangular 0/1 matrix, so A * T^-1
+  // is integral for a 0/1 A
+  static void randomATinvInput(std::mt19937 &gen, int varNum,
+                               MAPPING::Transform &T, MAPPING::Access &A) {
+    std::uniform_int_distribution<int> bit(0, 1);
+    std::vector<int> perm(varNum);
+    for (int i = 0; i < varNum; i++)
+      perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), gen);
+    T = MAPPING::Transform(varNum);
+    for (int i = 0; i < varNum; i++) {
+      T.setValue(i, perm[i], 1);
+      for (int j = perm[i] + 1; j < varNum; j++)
+        T.setValue(i, j, bit(gen));
+    }
+    auto matrix = std::make_shared<std::vector<MAPPING::mappingValueType>>();
+    for (int i = 0; i < 4 * varNum; i++)
+      matrix->push_back(bit(gen));
+    A = MAPPING::Access(varNum, matrix);
+  }
+
+  // compATinv takes fixed size matrices for 7 and 8 iterators, they have to
+  // give what the generic one gives
+  void checkATinv() {
+    std::mt19937 gen(0);
+    for (int varNum = 7; varNum <= 8; varNum++) {
+      for (int i = 0; i < 1000; i++) {
+        MAPPING::Transform T(varNum);
+        MAPPING::Access A;
+        randomATinvInput(gen, varNum, T, A);
+        std::vector<std::vector<int>> fixedMatrix;
+        std::vector<std::vector<int>> genericMatrix;
+        compATinv(T, A, fixedMatrix);
+        compATinvGeneric(T, A, genericMatrix);
+        DEBUG::check(fixedMatrix == genericMatrix, DEBUG::REUSEVECSOLVEERROR,
+                     "KernelBenchmark: compATinv != compATinvGeneric");
+      }
+    }
+  }
+
+  // the sram table the cost analysis interpolates
+  void defineCostTable() {
+    for (long long capacity = 64; capacity <= 262144; capacity *= 2) {
+      _sramCapacityVec.push_back(capacity);
+      _sramEnergyVec.push_back(_Cost._sramData.lookup(capacity, 0));
+    }
+  }
+
+public:
+  KernelBenchmark() : _T8(8) {
+    defineTask();
+    defineAccelerator();
+    defineCostTable();
+    _tileSearchEngine = std::make_shared<DSE::TileSearchEngine>(
+        _task._tensorMap[ARCH::INPUT], _task._tensorMap[ARCH::WEIGHT],
+        _task._tensorMap[ARCH::OUTPUT], _task._coupledVarVec);
+    _tileSearchEngine->split(_task._coupledVarVec[3], 5);
+    auto &coupledVarVec = _tileSearchEngine->getCoupledVarVec();
+    MAPPING::Transform T = defineT(coupledVarVec.size());
+    _analyzer = std::make_shared<Analyzer>(
+        coupledVarVec, T, _tileSearchEngine->getI(), _tileSearchEngine->getW(),
+        _tileSearchEngine->getO(), _acc._LVec[0], true);
+    DEBUG::check(_analyzer->constraintCheckAndBuildAnalyzer(),
+                 DEBUG::ERROR_OPTION, "KernelBenchmark: invalid mapping");
+    _analyzer->setBase({{_analyzer->_I.getDimNum(), _analyzer->_W.getDimNum(),
+                         _analyzer->_O.getDimNum()}});
+    _analyzer->setCurSubCoupledVarVec();
+    _analyzer->compAndCheckRequiredDataSize();
+    _analyzer->oneAnalysis();
+    _analyzer->constructInnerOuterTimeVec(_innerTimeVec, _outerTimeVec);
+    checkATinv();
+    std::mt19937 gen(1);
+    randomATinvInput(gen, 8, _T8, _A8);
+  }
+
+  void run(KernelOption &option, std::vector<KernelResult> &resultVec) {
+    Analyzer &a = *_analyzer;
+    std::vector<std::pair<std::string, std::function<long long()>>> kernelVec;
+    kernelVec.emplace_back("compReuseVec", [&a]() {
+      return (long long)compReuseVec(a._T, a._accessI)->size();
+    });
+    kernelVec.emplace_back("compATinv", [&a]() {
+      std::vector<std::vector<int>> matrix;
+      compATinv(a._T, a._accessI, matrix);
+      return (long long)matrix.size();
+    });
+    // the analyzer has 10 coupled iterators, 8 is the fixed size case
+    kernelVec.emplace_back("compATinv8", [this]() {
+      std::vector<std::vector<int>> matrix;
+      compATinv(_T8, _A8, matrix);
+      return (long long)matrix.size();
+    });
+    kernelVec.emplace_back("compATinvGeneric8", [this]() {
+      std::vector<std::vector<int>> matrix;
+      compATinvGeneric(_T8, _A8, matrix);
+      return (long long)matrix.size();
+    });
+    // rebinding the input to the coupled iterators of the analyzer leaves it
+    // as it is
+    kernelVec.emplace_back("constructAccessMatrix", [&a]() {
+      return (long long)MAPPING::constructAccessMatrix(a._I, a._coupledVarVec)
+          .getMatrix()
+          ->size();
+    });
+    kernelVec.emplace_back("Analyzer::compOneStateVolumn", [this, &a]() {
+      long long uniqueVolumn = 0;
+      long long totalVolumn = 0;
+      long long toSubVolumn = 0;
+      auto activateCountMap =
+          std::make_shared<std::map<std::pair<int, int>, long long>>();
+      a.compOneStateVolumn(uniqueVolumn, totalVolumn, toSubVolumn,
+                           _innerTimeVec, ARCH::INPUT, a._I, activateCountMap);
+      return uniqueVolumn + totalVolumn;
+    });
+    kernelVec.emplace_back("Analyzer::compTRange",
+                           [&a]() { return a.compTRange(2).second; });
+    kernelVec.emplace_back("Tensor::getEveryDimRange", [&a]() {
+      return a._oriI.getEveryDimRange()[2];
+    });
+    kernelVec.emplace_back("generateEdgeState", [&a]() {
+      std::vector<std::vector<int>> state;
+      WORKLOAD::generateEdgeState(state, a._coupledVarVec);
+      return (long long)state.size();
+    });
+    kernelVec.emplace_back("linearInterpolation", [this]() {
+      double ret = 0;
+      for (long long capacity = 100; capacity < 300000; capacity *= 3)
+        ret += COST::linearInterpolation(capacity, _sramCapacityVec,
+                                         _sramEnergyVec);
+      return (long long)ret;
+    });
+    kernelVec.emplace_back("NetworkGroup::getStableDelay", [&a]() {
+      std::pair<int, int> PEXRange = a.compTRange(0);
+      std::pair<int, int> PEYRange = a.compTRange(1);
+      return (long long)a._L.getStableDelay(ARCH::INPUT, 64, PEXRange,
+                                            PEYRange);
+    });
+    kernelVec.emplace_back("Transform::check",
+                           [&a]() { return (long long)a._T.check(); });
+    for (auto &kernel : kernelVec) {
+      if (!option._kernelName.empty() && kernel.first != option._kernelName)
+        continue;
+      resultVec.push_back(timeKernel(kernel.first, option, kernel.second));
+    }
+  }
+};
+
+void outputKernelResult(std::vector<KernelResult> &resultVec,
+                        KernelOption &option) {
+  std::ofstream ofile;
+  ofile.open(option._output, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"minTime\":" << option._minTime << ",\n";
+  ofile << "\"samples\":" << option._sampleNum << ",\n";
+  ofile << "\"kernels\":[\n";
+  for (int i = 0; i < resultVec.size(); i++) {
+    ofile << "{\"name\":\"" << resultVec[i].name << "\",";
+    ofile << "\"iterations\":" << resultVec[i].iterNum << ",";
+    ofile << "\"nsPerIter\":" << resultVec[i].nsPerIter << "}";
+    if (i != resultVec.size() - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "]\n}\n";
+  ofile.close();
+}
+
+int main(int argc, char **argv) {
+  KernelOption option;
+  parseKernelOption(argc, argv, option);
+  KernelBenchmark benchmark;
+  std::vector<KernelResult> resultVec;
+  benchmark.run(option, resultVec);
+  DEBUG::check(!resultVec.empty(), DEBUG::ERROR_OPTION, option._kernelName);
+  for (auto &r : resultVec)
+    std::cout << r.name << "\t" << r.nsPerIter << "ns\t" << r.iterNum
+              << " iterations" << std::endl;
+  outputKernelResult(resultVec, option);
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include "include/analysis/costAnalysis.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include "include/searchEngine/groupSearchEngine.h"
+#include "include/searchEngine/tileSearchEngine.h"
+#include "include/searchEngine/transformSearchEngine.h"
+#include "include/util/config.h"
+#include "include/util/debug.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+long long DSE::TransformSearchEngine::totalCount = 0;
+long long DSE::GroupSearchEngine::totalCount = 0;
+long long DSE::MultiLevelTransformSearchEngine::_resultCount = 0;
+extern COST::COSTDADA _Cost;
+
+// alexnet conv3 with k tiled by 16, eight iterators let up to eight
+// workers share the permutation roots of a level
+void defineThreadBenchTask(Task &task) {
+  auto k = task.defineIterator(384, "k", {16});
+  auto c = task.defineIterator(256, "c");
+  auto h = task.defineIterator(13, "h");
+  auto w = task.defineIterator(13, "w");
+  auto r = task.defineIterator(3, "r");
+  auto s = task.defineIterator(3, "s");
+  auto n = task.defineIterator(64, "n");
+
+  task.defineTensor(ARCH::INPUT, "I", {n, c, h + r, w + s});
+  task.defineTensor(ARCH::WEIGHT, "W", {k, c, r, s});
+  task.defineTensor(ARCH::OUTPUT, "O", {n, k, h, w});
+}
+
+void defineThreadBenchAccelerator(Accelerator &acc) {
+  acc.setDataWidth(16);
+  acc.addLevel(16, 16, false, true);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::INPUT, 256000000, 12800000000);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::WEIGHT, 256000000, 12800000000);
+  acc.addBuffer(0, ARCH::SRAM, ARCH::OUTPUT, 256000000, 12800000000);
+  acc.addNetworkGroup(0, ARCH::INPUT, {{1, 0, 0}});
+  acc.addNetworkGroup(0, ARCH::WEIGHT, {{0, 0, 1}});
+  acc.addNetworkGroup(0, ARCH::OUTPUT, {{0, 1, 0}});
+  acc.check();
+}
+
+struct ThreadBenchResult {
+  int workerNum;
+  double wallTime;
+  long long resultNum;
+  DSE::TransformThreadStat stat;
+};
+
+// --max-threads=N --repeat=N --output=file
+struct ThreadBenchOption {
+  int _maxThreadNum;
+  int _repeatNum;
+  std::string _output;
+  ThreadBenchOption()
+      : _maxThreadNum(std::max(1u, std::thread::hardware_concurrency())),
+        _repeatNum(3), _output("thread_bench_result.json") {}
+};
+
+void parseThreadBenchOption(int argc, char **argv, ThreadBenchOption &option) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string key = arg.substr(0, arg.find('='));
+    std::string value =
+        arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+    if (key == "--max-threads" && !value.empty()) {
+      option._maxThreadNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._maxThreadNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--repeat" && !value.empty()) {
+      option._repeatNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._repeatNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--output" && !value.empty()) {
+      option._output = value;
+    } else {
+      DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    }
+  }
+}
+
+// the run of the fastest wall time out of repeatNum
+void runThreadBench(Task &task, Accelerator &acc, int workerNum,
+                    int repeatNum, ThreadBenchResult &benchResult) {
+  benchResult.workerNum = workerNum;
+  for (int i = 0; i < repeatNum; i++) {
+    DSE::TileSearchEngine tileSearchEngine(
+        task._tensorMap[ARCH::INPUT], task._tensorMap[ARCH::WEIGHT],
+        task._tensorMap[ARCH::OUTPUT], task._coupledVarVec);
+    for (auto &p : task._allIteratorCandidate) {
+      for (auto candidate : p.second) {
+        tileSearchEngine.addCancidate(p.first, candidate);
+      }
+    }
+    for (auto &L : acc._LVec) {
+      ARCH::Level newL = L.clone();
+      tileSearchEngine.addLevel(newL);
+    }
+    Target target(acc.getLevelNum());
+    target.addTarget(0, 9, 1);
+    tileSearchEngine.setTarget(target);
+    tileSearchEngine.setWorkerNum(workerNum);
+
+    DSE::TransformSearchEngine::threadStat.reset();
+    // the search reports every tiling on stdout
+    std::cout.setstate(std::ios::failbit);
+    auto start = std::chrono::steady_clock::now();
+    tileSearchEngine.oneSearch();
+    auto end = std::chrono::steady_clock::now();
+    std::cout.clear();
+    double wallTime = std::chrono::duration<double>(end - start).count();
+    if (i == 0 || wallTime < benchResult.wallTime) {
+      std::vector<std::shared_ptr<GroupSearchResult>> resultVec;
+      tileSearchEngine.getResult(resultVec);
+      benchResult.wallTime = wallTime;
+      benchResult.resultNum = resultVec.size();
+      benchResult.stat = DSE::TransformSearchEngine::threadStat;
+    }
+  }
+}
+
+// 1, 2, 4, ... and maxThreadNum itself
+void getWorkerNumVec(int maxThreadNum, std::vector<int> &workerNumVec) {
+  for (int workerNum = 1; workerNum < maxThreadNum; workerNum *= 2)
+    workerNumVec.push_back(workerNum);
+  workerNumVec.push_back(maxThreadNum);
+}
+
+// speedup and efficiency are against one worker. the work of the workers is
+// the same for every worker num, so cpu time growing over that of one worker
+// is time lost to contention on shared data such as the reference counts of
+// the shared iterators. imbalance is the slowest worker over the mean worker
+void outputThreadBenchResult(std::vector<ThreadBenchResult> &benchResultVec,
+                             ThreadBenchOption &option) {
+  std::ofstream ofile;
+  ofile.open(option._output, std::ios::out);
+  double baseTime = benchResultVec[0].wallTime;
+  double baseCPUTime = benchResultVec[0].stat.cpuTime;
+  ofile << "{\n";
+  ofile << "\"repeat\":" << option._repeatNum << ",\n";
+  ofile << "\"hardwareConcurrency\":" << std::thread::hardware_concurrency()
+        << ",\n";
+  ofile << "\"runs\":[\n";
+  for (int i = 0; i < benchResultVec.size(); i++) {
+    auto &r = benchResultVec[i];
+    double speedup = r.wallTime > 0 ? baseTime / r.wallTime : 0;
+    double meanThreadNum =
+        r.stat.callNum > 0 ? double(r.stat.threadNum) / r.stat.callNum : 0;
+    double meanBusyTime =
+        r.stat.threadNum > 0 ? r.stat.busyTime / r.stat.threadNum : 0;
+    double meanMaxBusyTime =
+        r.stat.callNum > 0 ? r.stat.maxBusyTime / r.stat.callNum : 0;
+    ofile << "{\"workers\":" << r.workerNum << ",";
+    ofile << "\"wallTime\":" << r.wallTime << ",";
+    ofile << "\"speedup\":" << speedup << ",";
+    ofile << "\"efficiency\":" << speedup / r.workerNum << ",";
+    ofile << "\"results\":" << r.resultNum << ",";
+    ofile << "\"transformCalls\":" << r.stat.callNum << ",";
+    ofile << "\"meanThreadsPerCall\":" << meanThreadNum << ",";
+    ofile << "\"transformTime\":" << r.stat.totalTime << ",";
+    ofile << "\"threadCreateTime\":" << r.stat.createTime << ",";
+    ofile << "\"threadJoinTime\":" << r.stat.joinTime << ",";
+    ofile << "\"workerBusyTime\":" << r.stat.busyTime << ",";
+    ofile << "\"workerCPUTime\":" << r.stat.cpuTime << ",";
+    ofile << "\"cpuTimeInflation\":"
+          << (baseCPUTime > 0 ? r.stat.cpuTime / baseCPUTime : 0) << ",";
+    ofile << "\"imbalance\":"
+          << (meanBusyTime > 0 ? meanMaxBusyTime / meanBusyTime : 0) << "}";
+    if (i != benchResultVec.size() - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "]\n}\n";
+  ofile.close();
+}
+
+int main(int argc, char **argv) {
+  ThreadBenchOption option;
+  parseThreadBenchOption(argc, argv, option);
+  Task task;
+  defineThreadBenchTask(task);
+  Accelerator acc;
+  defineThreadBenchAccelerator(acc);
+  std::vector<int> workerNumVec;
+  getWorkerNumVec(option._maxThreadNum, workerNumVec);
+  std::vector<ThreadBenchResult> benchResultVec;
+  for (auto workerNum : workerNumVec) {
+    benchResultVec.emplace_back();
+    runThreadBench(task, acc, workerNum, option._repeatNum,
+                   benchResultVec.back());
+    auto &r = benchResultVec.back();
+    std::cout << r.workerNum << " workers\t" << r.wallTime << "s\tcreate "
+              << r.stat.createTime << "s\tjoin " << r.stat.joinTime
+              << "s\tcpu " << r.stat.cpuTime << "s" << std::endl;
+  }
+  outputThreadBenchResult(benchResultVec, option);
+  return 0;
+}
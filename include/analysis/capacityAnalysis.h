@@ -0,0 +1,42 @@
+#pragma once
+#include "include/datastruct/arch.h"
+#include "include/datastruct/workload.h"
+#include <numeric>
+#include <vector>
+// size-only buffer checks, computed from tensor footprints without building an
+// Analyzer
+namespace CAPACITY {
+// bytes one tensor occupies in the buffer of a level
+long long compRequiredDataSize(std::vector<long long> &dimRange, int dataWidth,
+                               bool doubleBufferFlag);
+
+// footprint of I/W/O under the current lock and edge state of the iterators
+void compRequiredDataSize(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
+                          WORKLOAD::Tensor &O, int dataWidth,
+                          bool doubleBufferFlag, long long requiredDataSize[3]);
+
+// check the footprint against the buffers of the level, free buffers are not
+// resized
+bool checkBufferSize(ARCH::Level &L, long long requiredDataSize[3]);
+
+// size-only counterpart of MultLevelAnalyzer::checkRequiredDataSize, answers
+// if a group fits every level before any analyzer is built
+class CapacityChecker {
+private:
+  WORKLOAD::Tensor &_I;
+  WORKLOAD::Tensor &_W;
+  WORKLOAD::Tensor &_O;
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> _allCoupledVarVec;
+  std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+      _coupledVarVecVec;
+  std::vector<ARCH::Level> _LVec;
+
+public:
+  CapacityChecker(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W, WORKLOAD::Tensor &O)
+      : _I(I), _W(W), _O(O) {}
+  void addLevel(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+                ARCH::Level &L);
+  bool compAndCheckRequiredDataSize(int level);
+  bool checkRequiredDataSize();
+};
+} // namespace CAPACITY
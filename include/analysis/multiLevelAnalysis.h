@@ -1,11 +1,19 @@
 #pragma once
 #include "include/analysis/singleLevelAnalysis.h"
 #include "include/datastruct/result.h"
+#include <atomic>
 #include <fstream>
+#include <map>
 #include <queue>
 #include <set>
 #include <vector>
 
+// result of a level analyzed as the sub level of its parent
+struct SubLevelResult {
+  std::shared_ptr<AnalyzerResult> _result;
+  std::vector<std::vector<long long>> _tensorDimRange;
+};
+
 class MultLevelAnalyzer {
 private:
   std::vector<Analyzer> _analyzerSet;
@@ -17,6 +25,19 @@ private:
       _coupledVarVecVec;
   std::vector<std::shared_ptr<AnalyzerResult>> _resultSet;
   std::vector<bool> _validFlags;
+  // T of every level as last checked by addLevel or changeT
+  std::vector<MAPPING::Transform> _levelTVec;
+  // the same T of a level always gets the same id
+  std::vector<std::map<std::vector<MAPPING::mappingValueType>, int>>
+      _TIdMapVec;
+  std::vector<int> _levelTIdVec;
+  // results of every level keyed by the T ids of the level and the levels
+  // below and by the ranges of their iterators, which is all the edge states
+  // above change. at most _subLevelResultCapacity per level are kept
+  std::vector<std::map<std::vector<int>, SubLevelResult>> _subLevelResultCache;
+  int _subLevelResultCapacity;
+  // false analyzes every sub level again, as a reference for the cache
+  bool _subLevelCacheFlag;
 
   void getSubLevelEdge(
       int level,
@@ -34,32 +55,47 @@ private:
       std::map<std::shared_ptr<WORKLOAD::Iterator>,
                std::shared_ptr<WORKLOAD::Iterator>> &subLevelEdgeMap,
       std::vector<Base> &baseVec);
+  SubLevelResult &analyzeSubLevel(int level);
   void recusiveAnalysis(int level);
   void compMultiLevelReuslt(std::shared_ptr<AnalyzerResult> resultTreeRoot);
-  void compMultiLevelReusltDFS(std::shared_ptr<AnalyzerResult> node, int level);
+  void compMultiLevelReusltDFS(std::shared_ptr<AnalyzerResult> node, int level,
+                               long long occTimes);
   void extendT(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
                int spatialDimNum, MAPPING::Transform &T);
   void extendCoupledVar(
       std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
       int spatialDimNum);
+  void addLevelT(MAPPING::Transform &T);
+  void setLevelTId(int level);
 
 public:
+  // oneAnalysis calls that passed the constraint check, over all analyzers
+  static std::atomic<long long> analysisCount;
   bool compAndCheckRequiredDataSize(int level);
   bool checkRequiredDataSize();
+  long long compMemoryBytes();
   MultLevelAnalyzer(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
                     WORKLOAD::Tensor &O)
-      : _I(I), _W(W), _O(O) {}
+      : _I(I), _W(W), _O(O), _subLevelResultCapacity(4096),
+        _subLevelCacheFlag(true) {}
+  void setSubLevelCacheFlag(bool flag) { _subLevelCacheFlag = flag; }
   void addLevel(std::vector<std::shared_ptr<WORKLOAD::Iterator>> coupledVarVec,
                 MAPPING::Transform &T, ARCH::Level &L,
                 bool doubleBufferFlag = true);
   void addLevel(std::vector<std::shared_ptr<WORKLOAD::Iterator>> coupledVarVec,
                 ARCH::Level &L, bool doubleBufferFlag = true);
+  void reset();
   bool changeT(int level,
                std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
                int spatialDimNum, MAPPING::Transform &T, bool checkFlag) {
     assert(level < _analyzerSet.size());
     if (checkFlag)
       extendT(coupledVarVec, spatialDimNum, T);
+    // the analyzer of an unchanged T is already built and checked
+    if (_levelTVec[level].equal(T))
+      return _validFlags[level];
+    _levelTVec[level].deepCopy(T);
+    setLevelTId(level);
     _analyzerSet[level].changeT(T);
     if (!_analyzerSet[level].constraintCheckAndBuildAnalyzer()) {
       _validFlags[level] = false;
@@ -69,6 +105,10 @@ public:
       return true;
     }
   }
+  // the funnel counter of why changeT last rejected the T of level
+  FUNNEL::Counter getRejectCounter(int level) {
+    return _analyzerSet[level].getRejectCounter();
+  }
   bool constraintCheck() {
     bool ret = true;
     for (auto flag : _validFlags) {
@@ -78,6 +118,11 @@ public:
     return ret;
   }
   void oneAnalysis();
+  bool partialAnalysis(int level);
+  std::shared_ptr<AnalyzerResult> getLevelResult(int level) {
+    assert(level < _resultSet.size());
+    return _resultSet[level];
+  }
   void outputCSVArrayName(std::string name, std::ofstream &logFile);
   void outputCSVArrayDoubleValue(double data[3], std::ofstream &logFile);
   void outputCSV();
@@ -99,7 +144,7 @@ public:
   void getTimeLine(int level) { _analyzerSet[level].getTimeLine(); }
 
   void getNetworkEnergy(ARCH::DATATYPE dataType) {
-    int levelNum = _analyzerSet.size();
+    int levelNum = _resultSet.size();
     for (int i = 0; i < levelNum; i++) {
 
       ARCH::Level &L = _analyzerSet[i].getLevel();
@@ -114,7 +159,7 @@ public:
   }
 
   void getNetworkArea(ARCH::DATATYPE dataType) {
-    int levelNum = _analyzerSet.size();
+    int levelNum = _resultSet.size();
     for (int i = 0; i < levelNum; i++) {
       ARCH::Level &L = _analyzerSet[i].getLevel();
       if (L.checkIfSlant(dataType)) {
@@ -128,7 +173,7 @@ public:
   }
 
   void getNetworkLeakagePower(ARCH::DATATYPE dataType) {
-    int levelNum = _analyzerSet.size();
+    int levelNum = _resultSet.size();
     for (int i = 0; i < levelNum; i++) {
       ARCH::Level &L = _analyzerSet[i].getLevel();
       if (L.checkIfSlant(dataType)) {
@@ -1,18 +1,23 @@
 #pragma once
 
+#include "include/analysis/capacityAnalysis.h"
 #include "include/datastruct/arch.h"
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/result.h"
 #include "include/datastruct/workload.h"
 #include "include/util/debug.h"
 #include "include/util/eigenUtil.h"
+#include "include/util/funnel.h"
 #include "include/util/timeline.h"
+#include "include/util/trace.h"
 #include <algorithm>
 #include <numeric>
 #include <set>
 #include <vector>
 class Analyzer {
 private:
+  // times the private kernels in isolation, see bench/kernelBenchmark.cpp
+  friend class KernelBenchmark;
   std::vector<std::shared_ptr<WORKLOAD::Iterator>> _coupledVarVec;
   std::vector<std::shared_ptr<WORKLOAD::Iterator>> _oriCoupledVarVec;
   MAPPING::Transform _T;
@@ -44,6 +49,27 @@ private:
   std::vector<std::shared_ptr<WORKLOAD::Iterator>> _curSubCoupledVarVec;
   std::set<std::shared_ptr<WORKLOAD::Iterator>> _curSubCoupledVarSet;
   int _curBaseIndex;
+  // PE rows of the last T the PE split and the access matrices were built
+  // for, and the number of extra temporal dims the split added to it
+  std::vector<MAPPING::mappingValueType> _builtPERowVec;
+  int _builtSplitNum;
+  // the PE split and the access matrices of every PE rows built in the group
+  struct PESplit {
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> _coupledVarVec;
+    std::shared_ptr<WORKLOAD::Iterator> _PEX;
+    std::shared_ptr<WORKLOAD::Iterator> _PEY;
+    WORKLOAD::Tensor _I;
+    WORKLOAD::Tensor _W;
+    WORKLOAD::Tensor _O;
+    MAPPING::Access _accessI;
+    MAPPING::Access _accessW;
+    MAPPING::Access _accessO;
+    int _splitNum;
+    bool _edgePEFlag;
+  };
+  std::map<std::vector<MAPPING::mappingValueType>, PESplit> _PESplitMap;
+  // why the last constraint check failed
+  FUNNEL::Counter _rejectCounter;
 
   std::pair<long long, long long> compTRange(int row);
   bool checkValidInnerDim(int varIndex, ARCH::DATATYPE dataType);
@@ -93,14 +119,41 @@ public:
            WORKLOAD::Tensor &O, ARCH::Level &L, bool doubleBufferFlag)
       : _oriCoupledVarVec(coupledVarVec), _T(T), _oriI(I), _oriW(W), _oriO(O),
         _L(L), _doubleBufferFlag(doubleBufferFlag), _curBaseIndex(0),
-        _edgePEFlag(false) {
+        _edgePEFlag(false), _builtSplitNum(0),
+        _rejectCounter(FUNNEL::TRANSFORM_REJECT_CHECK) {
     for (int i = 0; i < 3; i++)
-      _requiredDataSize[0] = 0;
+      _requiredDataSize[i] = 0;
     reset();
     _subNetworkExtended = false;
   }
   ARCH::Level &getLevel() { return _L; }
 
+  // bind a new group of the same level and tensors, the tensors are only
+  // shared again when a PE split has copied them
+  void rebind(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+              MAPPING::Transform &T, bool doubleBufferFlag) {
+    _oriCoupledVarVec = coupledVarVec;
+    _T = T;
+    _doubleBufferFlag = doubleBufferFlag;
+    _curBaseIndex = 0;
+    _curSubCoupledVarVec.clear();
+    _curSubCoupledVarSet.clear();
+    _baseSet.clear();
+    _tensorDimRange.clear();
+    _result.reset();
+    PEX.reset();
+    PEY.reset();
+    INNERTIME.reset();
+    for (int i = 0; i < 3; i++)
+      _requiredDataSize[i] = 0;
+    _builtPERowVec.clear();
+    _PESplitMap.clear();
+    if (_edgePEFlag)
+      reset();
+    else
+      _coupledVarVec = _oriCoupledVarVec;
+  }
+
   void buildAnalyzer() {
     if (!_accessI.isScalar())
       _reuseVecI = compReuseVec(_T, _accessI);
@@ -175,10 +228,10 @@ public:
       _coupledVarVec.push_back(outer);
       //_coupledVarVec.insert(_coupledVarVec.begin() + 2, outer);
       _T.addExtraTemporal();
-      // change Tensor
-      _I.splitIterator(PEIterator, outer, inner, peRange);
-      _W.splitIterator(PEIterator, outer, inner, peRange);
-      _O.splitIterator(PEIterator, outer, inner, peRange);
+      // change Tensor, the ones without PEIterator stay shared
+      _I.splitIteratorOnWrite(PEIterator, outer, inner, peRange);
+      _W.splitIteratorOnWrite(PEIterator, outer, inner, peRange);
+      _O.splitIteratorOnWrite(PEIterator, outer, inner, peRange);
       return true;
     } else {
       return true;
@@ -186,17 +239,42 @@ public:
   }
 
   void reset() {
+    _builtPERowVec.clear();
     _edgePEFlag = false;
     _coupledVarVec = _oriCoupledVarVec;
-    _O = _oriO;
-    _I = _oriI;
-    _W = _oriW;
+    _O.share(_oriO);
+    _I.share(_oriI);
+    _W.share(_oriW);
+  }
+
+  // the transform matrices of one permutation share the PE rows and come
+  // one after another, the PE split and the access matrices only depend on
+  // the PE rows and are kept for them. other PE rows seen in the group are
+  // looked up in _PESplitMap
+  bool checkSamePERow() {
+    auto &matrix = *_T.getMatrix();
+    int PERowSize = 2 * _T.getColNum();
+    return _builtPERowVec.size() == PERowSize &&
+           std::equal(_builtPERowVec.begin(), _builtPERowVec.end(),
+                      matrix.begin());
   }
 
   bool constraintCheckAndBuildAnalyzer() {
+    if (checkSamePERow())
+      return constraintCheckAndBuildAnalyzerSamePE();
+    int colNum = _T.getColNum();
+    std::vector<MAPPING::mappingValueType> PERowVec(
+        _T.getMatrix()->begin(), _T.getMatrix()->begin() + 2 * colNum);
+    auto it = _PESplitMap.find(PERowVec);
+    if (it != _PESplitMap.end()) {
+      loadPESplit(it->second);
+      _builtPERowVec = PERowVec;
+      return constraintCheckAndBuildAnalyzerSamePE();
+    }
+    // a failed split leaves the analyzer built for none
+    _builtPERowVec.clear();
     if (_edgePEFlag)
       reset();
-    int colNum = _T.getColNum();
     for (int i = 0; i < colNum; i++) {
       if (_T(0, i) == 1)
         PEX = _coupledVarVec[i];
@@ -207,8 +285,11 @@ public:
       if (_T(2, i) == 1 && _T(0, i) != 1 && _T(1, i) != 1)
         INNERTIME = _coupledVarVec[i];
     }
-    if (!_T.check())
+    if (!_T.check()) {
+      _rejectCounter = FUNNEL::TRANSFORM_REJECT_CHECK;
       return false;
+    }
+    _rejectCounter = FUNNEL::TRANSFORM_REJECT_PE;
     if (PEX->hasEdge())
       return false;
     if (PEY->hasEdge())
@@ -226,7 +307,60 @@ public:
     _accessI = MAPPING::constructAccessMatrix(_I, _coupledVarVec);
     _accessW = MAPPING::constructAccessMatrix(_W, _coupledVarVec);
     _accessO = MAPPING::constructAccessMatrix(_O, _coupledVarVec);
+    _builtPERowVec = PERowVec;
+    _builtSplitNum = _T.getColNum() - colNum;
+    storePESplit(_PESplitMap[PERowVec]);
+    return checkAndBuildReuse();
+  }
+
+  // the tensors of an entry are shared, a later split copies the ones it
+  // changes
+  void storePESplit(PESplit &split) {
+    split._coupledVarVec = _coupledVarVec;
+    split._PEX = PEX;
+    split._PEY = PEY;
+    split._I.share(_I);
+    split._W.share(_W);
+    split._O.share(_O);
+    split._accessI = _accessI;
+    split._accessW = _accessW;
+    split._accessO = _accessO;
+    split._splitNum = _builtSplitNum;
+    split._edgePEFlag = _edgePEFlag;
+  }
+  void loadPESplit(PESplit &split) {
+    _coupledVarVec = split._coupledVarVec;
+    PEX = split._PEX;
+    PEY = split._PEY;
+    _I.share(split._I);
+    _W.share(split._W);
+    _O.share(split._O);
+    _accessI = split._accessI;
+    _accessW = split._accessW;
+    _accessO = split._accessO;
+    _builtSplitNum = split._splitNum;
+    _edgePEFlag = split._edgePEFlag;
+  }
+
+  // PEX, PEY and the split iterators are those of the last built T
+  bool constraintCheckAndBuildAnalyzerSamePE() {
+    int colNum = _T.getColNum();
+    for (int i = 0; i < colNum; i++) {
+      if (_T(2, i) == 1 && _T(0, i) != 1 && _T(1, i) != 1)
+        INNERTIME = _coupledVarVec[i];
+    }
+    if (!_T.check()) {
+      _rejectCounter = FUNNEL::TRANSFORM_REJECT_CHECK;
+      return false;
+    }
+    for (int i = 0; i < _builtSplitNum; i++)
+      _T.addExtraTemporal();
+    return checkAndBuildReuse();
+  }
+
+  bool checkAndBuildReuse() {
     buildAnalyzer();
+    _rejectCounter = FUNNEL::TRANSFORM_REJECT_NETWORK_REUSE;
     if (!_L.checkNetworkReuseValid(ARCH::INPUT, _reuseVecI))
       return false;
     if (!_L.checkNetworkReuseValid(ARCH::WEIGHT, _reuseVecW))
@@ -237,6 +371,7 @@ public:
   }
   void getTimeLine() { TIMELINE::getTimeLine(_coupledVarVec, _T, _I, _W, _O); }
   MAPPING::Transform getT() { return _T; }
+  FUNNEL::Counter getRejectCounter() { return _rejectCounter; }
   void outputReuseVec(std::shared_ptr<std::vector<std::vector<int>>> reuseVec,
                       std::ofstream &logFile) {
     std::string ret;
@@ -596,6 +596,18 @@ public:
   Level(int dataWidth, bool peFlag = false, bool doubleBufferFlag = false)
       : Level(1, 1, dataWidth, peFlag, doubleBufferFlag, 0) {}
   bool getDoubleBufferFlag() { return _doubleBufferFlag; }
+  // copy with its own buffers for a search in another thread, free buffers
+  // are then sized per copy
+  Level clone() {
+    Level ret = *this;
+    ret._bufferSet =
+        std::make_shared<std::map<DATATYPE, std::shared_ptr<Buffer>>>();
+    for (auto &p : *_bufferSet) {
+      (*ret._bufferSet)[p.first] =
+          p.second == nullptr ? nullptr : std::make_shared<Buffer>(*p.second);
+    }
+    return ret;
+  }
   void setFreeBufferCapacity(long long capacityInput, long long capacityWeight,
                              long long capacityOutput) {
     if (_inputWeightSharedBWFlag) {
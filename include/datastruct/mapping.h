@@ -30,6 +30,14 @@ public:
   }
 
   int getColNum() { return _colNum; }
+  // the matrix and its control block, counted for every copy sharing them
+  long long compMemoryBytes() {
+    return sizeof(Matrix2D) + sizeof(*_value) + 16 +
+           _value->capacity() * sizeof(mappingValueType);
+  }
+  bool equal(Matrix2D &other) {
+    return _colNum == other._colNum && *_value == *other._value;
+  }
   int getRowNum() { return _value->size() / _colNum; }
   std::shared_ptr<std::vector<mappingValueType>> getMatrix() { return _value; }
   void setValue(int i, int j, int num) { (*_value)[i * _colNum + j] = num; }
@@ -73,11 +81,14 @@ public:
       : Matrix2D(dimNum, transformMatrix) {}
   Transform(int dimNum) : Matrix2D(dimNum) {}
 
+  // the matrix is written in place unless a copy of this Transform still
+  // shares it
   Transform &deepCopy(Transform &other) {
     _colNum = other._colNum;
-    _value = std::make_shared<std::vector<mappingValueType>>(
-        std::vector<mappingValueType>(_colNum * _colNum, 0));
-    *_value = *other._value;
+    if (_value.use_count() == 1 && _value != other._value)
+      *_value = *other._value;
+    else
+      _value = std::make_shared<std::vector<mappingValueType>>(*other._value);
     return *this;
   }
   void addExtraSpatial() {
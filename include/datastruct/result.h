@@ -1,5 +1,7 @@
 #pragma once
 #include "include/datastruct/mapping.h"
+#include "include/util/memory.h"
+#include "include/util/trace.h"
 #include <memory>
 #include <vector>
 struct Base {
@@ -111,6 +113,19 @@ struct AnalyzerResult {
     subLevelResultVec.clear();
   }
 
+  // the results of the sub levels are shared with the analyzer caches and
+  // are not counted
+  long long compMemoryBytes() {
+    long long bytes = sizeof(AnalyzerResult) +
+                      subLevelResultVec.capacity() *
+                          sizeof(std::shared_ptr<AnalyzerResult>);
+    for (int i = 0; i < 3; i++) {
+      if (activateCountMapVec[i])
+        bytes += MEMORY::compMapBytes(*activateCountMapVec[i]);
+    }
+    return bytes;
+  }
+
   AnalyzerResult &operator+=(AnalyzerResult &other) {
     for (int i = 0; i < 3; i++) {
       uniqueVolumn[i] += other.uniqueVolumn[i] * other.occTimes;
@@ -318,14 +333,39 @@ struct GroupSearchResult {
       _coupledVarVecVec;
   std::shared_ptr<MultiLevelTransformSearchResult>
       _multiLevelTransformSearchResult;
+  MEMORY::Usage _usage;
+  MEMORY::Usage _resultUsage;
   GroupSearchResult(
       std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
           coupledVarVecVec,
       std::shared_ptr<MultiLevelTransformSearchResult>
           multiLevelTransformSearchResult)
       : _multiLevelTransformSearchResult(multiLevelTransformSearchResult),
-        _coupledVarVecVec(coupledVarVecVec), score(0) {}
+        _coupledVarVecVec(coupledVarVecVec), score(0),
+        _usage(MEMORY::GROUP_RESULT), _resultUsage(MEMORY::ANALYZER_RESULT) {
+    compMemoryBytes();
+  }
+  // the tree and the AnalyzerResults of its levels
+  void compMemoryBytes() {
+    long long bytes = sizeof(GroupSearchResult);
+    for (auto &coupledVarVec : _coupledVarVecVec)
+      bytes += sizeof(coupledVarVec) +
+               coupledVarVec.capacity() *
+                   sizeof(std::shared_ptr<WORKLOAD::Iterator>);
+    long long resultBytes = 0;
+    if (_multiLevelTransformSearchResult) {
+      bytes += sizeof(MultiLevelTransformSearchResult);
+      for (auto &result :
+           _multiLevelTransformSearchResult->_transformSearchResult) {
+        bytes += sizeof(TransformSearchResult) + result->_T.compMemoryBytes();
+        resultBytes += result->_result->compMemoryBytes();
+      }
+    }
+    _usage.set(bytes);
+    _resultUsage.set(resultBytes);
+  }
   void outputLog(std::ofstream &logFile, int index, int levelNum) {
+    TRACE_SPAN("GroupSearchResult::outputLog");
     logFile << " \"Group Search: "
             << std::to_string(_multiLevelTransformSearchResult->_index);
     for (int i = 0; i < levelNum; i++) {
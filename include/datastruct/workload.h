@@ -3,6 +3,7 @@
 #include "include/util/debug.h"
 #include <assert.h>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -72,6 +73,9 @@ public:
     return _lock ? 0 : (_edgeFlag ? _upBound + 1 : _lowBound);
   }
   int getUpBound() { return _lock ? 0 : (_edgeFlag ? _upBound + 1 : _upBound); }
+  // the range of an edge child while its parent is at the edge
+  int getEdgeLowBound() { return _edgeLowBound; }
+  int getEdgeUpBound() { return _edgeUpBound; }
   void lock() { _lock = true; }
   void unlock() { _lock = false; }
   bool islock() { return _lock; }
@@ -96,8 +100,12 @@ public:
   }
   bool isEdge() { return _edgeFlag; }
   std::shared_ptr<Iterator> getCoupledIterator() { return _coupledIterator; }
+  void setCoupledIterator(std::shared_ptr<Iterator> coupledIterator) {
+    _coupledIterator = coupledIterator;
+  }
   bool hasEdge() { return _hasEdge; }
   void reset() { _cur = 0; }
+  void setCur(int cur) { _cur = cur; }
   void getNext() {
     if (isTop()) {
       _cur = _lowBound;
@@ -279,6 +287,17 @@ public:
       _monomialSet = _newMonomialSet;
     }
   }
+  // new monomials on the iterators varMap maps to
+  std::shared_ptr<Polynomial>
+  clone(std::map<std::shared_ptr<Iterator>, std::shared_ptr<Iterator>> &varMap) {
+    auto ret = std::make_shared<Polynomial>();
+    for (auto &m : *_monomialSet) {
+      auto var = varMap.count(m->getVar()) ? varMap[m->getVar()] : m->getVar();
+      ret->_monomialSet->push_back(
+          std::make_shared<Monomial>(var, m->getCoef()));
+    }
+    return ret;
+  }
 }; // end of Polynomial
 std::shared_ptr<Polynomial> operator+(std::shared_ptr<Monomial> var1,
                                       std::shared_ptr<Monomial> var2);
@@ -303,12 +322,18 @@ std::shared_ptr<Polynomial> operator*(std::shared_ptr<Polynomial> var1,
 void generateEdgeState(
     std::vector<std::vector<int>> &state,
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> &curSubCoupledVarVec);
+// copy the iterators for a search in another thread, varMap maps every
+// iterator to its copy
+void cloneIterator(
+    std::vector<std::shared_ptr<Iterator>> &varVec,
+    std::vector<std::shared_ptr<Iterator>> &newVarVec,
+    std::map<std::shared_ptr<Iterator>, std::shared_ptr<Iterator>> &varMap);
 class Tensor {
 private:
   std::shared_ptr<std::vector<std::shared_ptr<Polynomial>>> _dimensionTable;
   std::string _sym;
   std::shared_ptr<std::vector<int>> _coupled;
-  std::set<std::shared_ptr<WORKLOAD::Iterator>> _varSet;
+  std::shared_ptr<std::set<std::shared_ptr<WORKLOAD::Iterator>>> _varSet;
   int compOneStateVolumn() {
     int ret = 1;
     for (auto dim : *_dimensionTable) {
@@ -317,28 +342,36 @@ private:
     }
     return ret;
   }
+  void copyDimensionTable() {
+    auto dimensionTable =
+        std::make_shared<std::vector<std::shared_ptr<Polynomial>>>();
+    for (auto &oriP : *_dimensionTable) {
+      std::shared_ptr<Polynomial> p = std::make_shared<Polynomial>();
+      *p = *oriP;
+      dimensionTable->push_back(p);
+    }
+    _dimensionTable = dimensionTable;
+  }
 
 public:
   Tensor() {
     _dimensionTable =
         std::make_shared<std::vector<std::shared_ptr<Polynomial>>>();
+    _varSet = std::make_shared<std::set<std::shared_ptr<WORKLOAD::Iterator>>>();
   }
   Tensor &operator=(const Tensor &arr) {
-    _dimensionTable =
-        std::make_shared<std::vector<std::shared_ptr<Polynomial>>>();
+    share(arr);
+    copyDimensionTable();
+    return *this;
+  }
+  Tensor(std::string sym) : Tensor() { _sym = sym; }
+  // shares the dimensions of arr where operator= copies them,
+  // splitIteratorOnWrite copies them before a split changes one
+  void share(const Tensor &arr) {
+    _dimensionTable = arr._dimensionTable;
     _sym = arr._sym;
     _coupled = arr._coupled;
     _varSet = arr._varSet;
-    for (auto &oriP : *(arr._dimensionTable)) {
-      std::shared_ptr<Polynomial> p = std::make_shared<Polynomial>();
-      *p = *oriP;
-      _dimensionTable->push_back(p);
-    }
-    return *this;
-  }
-  Tensor(std::string sym) : _sym(sym) {
-    _dimensionTable =
-        std::make_shared<std::vector<std::shared_ptr<Polynomial>>>();
   }
   int getDimensionNum() { return _dimensionTable->size(); }
   int lookupVar(std::shared_ptr<Iterator> i, int dim) {
@@ -368,11 +401,29 @@ public:
     }
   }
 
+  void splitIteratorOnWrite(std::shared_ptr<WORKLOAD::Iterator> oriIterator,
+                            std::shared_ptr<WORKLOAD::Iterator> outer,
+                            std::shared_ptr<WORKLOAD::Iterator> inner,
+                            int tileSize) {
+    bool splitFlag = false;
+    for (auto &dim : *_dimensionTable)
+      splitFlag = splitFlag || dim->lookupVar(oriIterator);
+    if (!splitFlag)
+      return;
+    if (_dimensionTable.use_count() > 1)
+      copyDimensionTable();
+    splitIterator(oriIterator, outer, inner, tileSize);
+  }
+
   void constructVarSet(std::shared_ptr<Polynomial> dim) {
+    if (_varSet.use_count() > 1)
+      _varSet =
+          std::make_shared<std::set<std::shared_ptr<WORKLOAD::Iterator>>>(
+              *_varSet);
     auto oneDimVarVec = dim->getVarVec();
     for (auto var : oneDimVarVec) {
-      if (!_varSet.count(var)) {
-        _varSet.insert(var);
+      if (!_varSet->count(var)) {
+        _varSet->insert(var);
       }
     }
   }
@@ -426,7 +477,7 @@ public:
 
   int getVolumn() {
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> varVec;
-    for (auto it = _varSet.begin(); it != _varSet.end(); it++) {
+    for (auto it = _varSet->begin(); it != _varSet->end(); it++) {
       varVec.push_back(*it);
     }
     std::vector<std::vector<int>> state;
@@ -507,6 +558,19 @@ public:
     return (*_dimensionTable)[index]->lookupVar(curIterator);
   }
 
+  // deep copy on the iterators varMap maps to, shares nothing with this
+  Tensor
+  clone(std::map<std::shared_ptr<Iterator>, std::shared_ptr<Iterator>> &varMap) {
+    Tensor ret(_sym);
+    for (auto &dim : *_dimensionTable)
+      ret._dimensionTable->push_back(dim->clone(varMap));
+    if (_coupled != nullptr)
+      ret._coupled = std::make_shared<std::vector<int>>(*_coupled);
+    for (auto &var : *_varSet)
+      ret._varSet->insert(varMap.count(var) ? varMap[var] : var);
+    return ret;
+  }
+
 }; // end of Tensor
 
 } // namespace WORKLOAD
\ No newline at end of file
@@ -18,6 +18,15 @@ class GroupSearchEngine {
   std::vector<int> _spatialNumVec;
   std::vector<ARCH::Level> _LVec;
   bool _firstFlag;
+  AnalyzerPool _analyzerPool;
+  int _beamWidth;
+  std::vector<double> _beamWeightVec;
+  // set by estimate, every _estimateStride-th group is sampled into
+  // _estimate instead of searched
+  SearchEstimate *_estimate;
+  long long _estimateStride;
+  long long _estimateIndex;
+  int _estimateEvaluationNum;
 
 public:
   std::vector<std::shared_ptr<GroupSearchResult>> _groupSearchResult;
@@ -25,12 +34,21 @@ public:
   static long long totalCount;
   GroupSearchEngine(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
                     WORKLOAD::Tensor &O,
-                    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &varVec)
-      : _I(I), _W(W), _O(O), _varVec(varVec), _firstFlag(false) {}
+                    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &varVec,
+                    int workerNum = std::thread::hardware_concurrency())
+      : _I(I), _W(W), _O(O), _varVec(varVec), _firstFlag(false),
+        _analyzerPool(I, W, O, workerNum), _beamWidth(0),
+        _estimate(nullptr), _estimateStride(1), _estimateIndex(0),
+        _estimateEvaluationNum(0) {}
   void addLevel(ARCH::Level &L) {
     _LVec.emplace_back(L);
     _spatialNumVec.push_back(L.getSpatialDimNum());
   }
+  // see MultiLevelTransformSearchEngine::beamSearch
+  void setBeam(int beamWidth, std::vector<double> &beamWeightVec) {
+    _beamWidth = beamWidth;
+    _beamWeightVec = beamWeightVec;
+  }
 
 
   void combine(int n, int k, std::vector<Group> &groupVec);
@@ -50,6 +68,11 @@ public:
 
   void oneSearch(std::ofstream &logFile, bool logFlag);
 
+  long long recusiveCountGroup(std::vector<int> &perGroupNum, int varNum,
+                               int levelNum);
+  long long countGroup();
+  void estimate(SearchEstimate &estimate, int sampleNum, int evaluationNum);
+
   static bool cmpResultByTotalCycle(std::shared_ptr<GroupSearchResult> &r1,
                                     std::shared_ptr<GroupSearchResult> &r2) {
     int levelSize =
@@ -0,0 +1,152 @@
+#pragma once
+#include "include/analysis/capacityAnalysis.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include "include/searchEngine/tileSearchEngine.h"
+#include "include/searchEngine/transformSearchEngine.h"
+#include "include/util/config.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace DSE {
+// one point of the whole mapping space. every original iterator has two
+// parts, the inner part and the outer part that exists only after a split
+// part 2 * i is the inner part of iterator i, part 2 * i + 1 the outer part
+struct MappingGenome {
+  // index into the tile candidates of every tiled iterator
+  std::vector<int> _tileIndexVec;
+  // level of every part
+  std::vector<int> _partLevelVec;
+  // loop order in a level is the ascending order of the keys, the first
+  // spatialDimNum parts are mapped to PE
+  std::vector<double> _partKeyVec;
+  // which transform matrix of generateTransformMatrix every level takes
+  std::vector<int> _TIndexVec;
+  // if the part exists under the tiling, set by decode
+  std::vector<bool> _partLiveVec;
+};
+
+// loop order and transform matrix of every level that passed the
+// constraints, in the order of the genome keys
+struct MappingRepair {
+  std::vector<std::vector<int>> _permuteVec;
+  std::vector<int> _TIndexVec;
+};
+
+// decode a genome to a tiling, a grouping and one transform matrix per level
+// and analyze it with MultLevelAnalyzer
+class MappingEvaluator {
+  TileSearchEngine &_tileSearchEngine;
+  Target &_target;
+  // tiled iterators in the order of _tileIndexVec
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> _tileVarVec;
+  std::vector<int> _tileVarIndexVec;
+  std::vector<int> _minVarNumVec;
+  // results of the decoded mappings already analyzed, nullptr if invalid
+  std::map<std::vector<int>,
+           std::pair<std::shared_ptr<GroupSearchResult>, MappingRepair>>
+      _cache;
+  long long _evaluationCount;
+
+  bool decode(MappingGenome &genome,
+              std::vector<std::vector<int>> &levelPartVec,
+              std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+                  &coupledVarVecVec);
+  static int getTransformNum(int dimNum, int spatialDimNum);
+  void getMappingKey(MappingGenome &genome,
+                     std::vector<std::vector<int>> &levelPartVec,
+                     std::vector<int> &mappingKey);
+  bool changeLevelT(
+      MultLevelAnalyzer &multanalysis, int level,
+      std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+      int &TIndex, std::vector<int> &permute);
+  std::shared_ptr<GroupSearchResult>
+  analyze(MappingGenome &genome,
+          std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+              &coupledVarVecVec,
+          MappingRepair &repair);
+  void applyRepair(MappingGenome &genome,
+                   std::vector<std::vector<int>> &levelPartVec,
+                   MappingRepair &repair);
+
+public:
+  MappingEvaluator(TileSearchEngine &tileSearchEngine, Target &target);
+  int getLevelNum() { return _minVarNumVec.size(); }
+  int getPartNum() {
+    return _tileSearchEngine.getOriCoupledVarVec().size() * 2;
+  }
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> &getTileVarVec() {
+    return _tileVarVec;
+  }
+  // index of the i-th tiled iterator in the original iterators
+  int getTileVarIndex(int i) { return _tileVarIndexVec[i]; }
+  long long getEvaluationCount() { return _evaluationCount; }
+  void randomGenome(MappingGenome &genome, std::mt19937 &rng);
+  // nullptr if the mapping does not fit or no loop order of a level is valid,
+  // the genome is repaired to the mapping analyzed and mappingKey identifies
+  // the mapping
+  std::shared_ptr<GroupSearchResult> evaluate(MappingGenome &genome,
+                                              bool &newFlag,
+                                              std::vector<int> &mappingKey);
+  std::shared_ptr<GroupSearchResult> evaluate(MappingGenome &genome,
+                                              bool &newFlag);
+  void mutate(MappingGenome &genome, std::mt19937 &rng);
+  void crossover(MappingGenome &genome1, MappingGenome &genome2,
+                 MappingGenome &child, std::mt19937 &rng);
+};
+
+// simulated annealing over MappingGenome, or pure random sampling
+class StochasticSearchEngine {
+  TileSearchEngine &_tileSearchEngine;
+  Target &_target;
+  SearchOption &_option;
+  MappingEvaluator _evaluator;
+  std::mt19937 _rng;
+
+public:
+  StochasticSearchEngine(TileSearchEngine &tileSearchEngine, Target &target,
+                         SearchOption &option)
+      : _tileSearchEngine(tileSearchEngine), _target(target), _option(option),
+        _evaluator(tileSearchEngine, target), _rng(option._seed) {}
+  void oneSearch();
+};
+
+// genetic search over MappingGenome, the fitness of every generation is
+// evaluated in parallel on clones of the tile search engine
+class GeneticSearchEngine {
+public:
+  struct Individual {
+    MappingGenome _genome;
+    std::shared_ptr<GroupSearchResult> _result;
+    std::vector<int> _mappingKey;
+    bool _newFlag;
+    Individual() : _newFlag(false) {}
+  };
+
+private:
+  TileSearchEngine &_tileSearchEngine;
+  Target &_target;
+  SearchOption &_option;
+  std::vector<std::shared_ptr<TileSearchEngine>> _tileSearchEngineVec;
+  std::vector<std::shared_ptr<MappingEvaluator>> _evaluatorVec;
+  std::set<std::vector<int>> _resultKeySet;
+  std::mt19937 _rng;
+
+  void evaluate(std::vector<Individual> &individualVec);
+  Individual &select(std::vector<Individual> &population);
+
+public:
+  GeneticSearchEngine(TileSearchEngine &tileSearchEngine, Target &target,
+                      SearchOption &option);
+  void oneSearch();
+};
+void evaluateIndividualMultiThread(
+    MappingEvaluator &evaluator,
+    std::vector<GeneticSearchEngine::Individual> &individualVec, int step,
+    int stride);
+} // namespace DSE
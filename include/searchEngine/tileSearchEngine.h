@@ -1,7 +1,13 @@
+#pragma once
+#include "include/analysis/capacityAnalysis.h"
 #include "include/datastruct/arch.h"
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/workload.h"
 #include "include/searchEngine/groupSearchEngine.h"
+#include "include/util/pareto.h"
+#include "include/util/progress.h"
+#include <cstdio>
+#include <limits>
 namespace DSE {
 
 
@@ -27,15 +33,114 @@ private:
       _allIteratorCandidate;
   std::vector<ARCH::Level> _LVec;
   std::vector<std::shared_ptr<GroupSearchResult>> _groupSearchResult;
+  std::vector<std::pair<int, int>> _paretoObjectiveVec;
+  ParetoFront<std::shared_ptr<GroupSearchResult>> _paretoFront;
+  int _beamWidth;
+  std::vector<double> _beamWeightVec;
+  // threads of generateAllTransformMatrix, 0 means hardware concurrency
+  int _workerNum;
+  // the best _snapshotNum results are written to _snapshotName whenever
+  // PROGRESS asks for a snapshot, empty for never
+  std::string _snapshotName;
+  std::shared_ptr<Target> _snapshotTarget;
+  int _snapshotNum;
 
 public:
   TileSearchEngine(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
                    WORKLOAD::Tensor &O,
                    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &varVec)
-      : _oriI(I), _oriW(W), _oriO(O), _oriCoupledVarVec(varVec) {
+      : _oriI(I), _oriW(W), _oriO(O), _oriCoupledVarVec(varVec),
+        _beamWidth(0), _workerNum(0), _snapshotNum(0) {
     reset();
   }
 
+  // in pareto mode only the non-dominated results are kept while searching
+  void setTarget(Target &target) {
+    _paretoObjectiveVec = target._paretoObjectiveVec;
+    _paretoFront = ParetoFront<std::shared_ptr<GroupSearchResult>>(
+        _paretoObjectiveVec.size());
+    _beamWeightVec = std::vector<double>(12, 0);
+    for (auto &levelTarget : target._t) {
+      for (int j = 0; j < 12; j++)
+        _beamWeightVec[j] += levelTarget[j];
+    }
+    for (auto &p : _paretoObjectiveVec)
+      _beamWeightVec[p.second] += 1;
+  }
+
+  // keep only the beamWidth best partial mappings per level instead of
+  // analyzing every combination of transform matrices, 0 to disable
+  void setBeamWidth(int beamWidth) { _beamWidth = beamWidth; }
+  void setWorkerNum(int workerNum) { _workerNum = workerNum; }
+  void setSnapshot(std::string name, Target &target, int num) {
+    _snapshotName = name;
+    _snapshotTarget = std::make_shared<Target>(target);
+    _snapshotNum = num;
+  }
+
+  void addResult(std::shared_ptr<GroupSearchResult> &result) {
+    if (_paretoObjectiveVec.empty()) {
+      _groupSearchResult.push_back(result);
+      return;
+    }
+    std::vector<double> objective;
+    for (auto &p : _paretoObjectiveVec)
+      objective.push_back(getTargetValue(*result, p.first, p.second));
+    _paretoFront.insert(objective, result);
+  }
+
+  WORKLOAD::Tensor &getI() { return _I; }
+  WORKLOAD::Tensor &getW() { return _W; }
+  WORKLOAD::Tensor &getO() { return _O; }
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> &getOriCoupledVarVec() {
+    return _oriCoupledVarVec;
+  }
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> &getCoupledVarVec() {
+    return _coupledVarVec;
+  }
+  std::map<std::shared_ptr<WORKLOAD::Iterator>, std::vector<int>> &
+  getIteratorCandidate() {
+    return _allIteratorCandidate;
+  }
+  std::vector<ARCH::Level> &getLevelVec() { return _LVec; }
+
+  // engine on copies of the tensors, iterators and buffers, searches
+  // independent of this one in another thread
+  std::shared_ptr<TileSearchEngine> clone() {
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> varVec;
+    std::map<std::shared_ptr<WORKLOAD::Iterator>,
+             std::shared_ptr<WORKLOAD::Iterator>>
+        varMap;
+    WORKLOAD::cloneIterator(_oriCoupledVarVec, varVec, varMap);
+    WORKLOAD::Tensor I = _oriI.clone(varMap);
+    WORKLOAD::Tensor W = _oriW.clone(varMap);
+    WORKLOAD::Tensor O = _oriO.clone(varMap);
+    auto ret = std::make_shared<TileSearchEngine>(I, W, O, varVec);
+    for (auto &p : _allIteratorCandidate) {
+      for (auto candidate : p.second)
+        ret->addCancidate(varMap[p.first], candidate);
+    }
+    for (auto &L : _LVec) {
+      ARCH::Level newL = L.clone();
+      ret->addLevel(newL);
+    }
+    ret->_paretoObjectiveVec = _paretoObjectiveVec;
+    ret->_beamWidth = _beamWidth;
+    ret->_workerNum = _workerNum;
+    ret->_beamWeightVec = _beamWeightVec;
+    ret->_paretoFront = ParetoFront<std::shared_ptr<GroupSearchResult>>(
+        _paretoObjectiveVec.size());
+    return ret;
+  }
+
+  // move the pareto front to the results once the search is over
+  void flushResult() {
+    if (!_paretoObjectiveVec.empty()) {
+      _groupSearchResult.clear();
+      _paretoFront.getFront(_groupSearchResult);
+    }
+  }
+
   // add candidate to iterator
   void addCancidate(std::shared_ptr<WORKLOAD::Iterator> iterator,
                     int candidate) {
@@ -88,6 +193,53 @@ public:
     _O.splitIterator(iterator, outer, inner, size);
   }
 
+  // check if the smallest footprint of any varNum iterators fits the level
+  bool checkMinRequiredDataSize(ARCH::Level &L, int varNum) {
+    int coupledVarNum = _coupledVarVec.size();
+    std::vector<bool> unlockFlags(coupledVarNum, false);
+    std::fill(unlockFlags.begin(), unlockFlags.begin() + varNum, true);
+    long long requiredDataSize[3];
+    bool ret = false;
+    do {
+      for (int i = 0; i < coupledVarNum; i++) {
+        if (unlockFlags[i])
+          _coupledVarVec[i]->unlock();
+        else
+          _coupledVarVec[i]->lock();
+      }
+      CAPACITY::compRequiredDataSize(_I, _W, _O, L.getDataWidth(),
+                                     L.getDoubleBufferFlag(),
+                                     requiredDataSize);
+      ret = CAPACITY::checkBufferSize(L, requiredDataSize);
+    } while (!ret &&
+             std::prev_permutation(unlockFlags.begin(), unlockFlags.end()));
+    for (auto &var : _coupledVarVec)
+      var->unlock();
+    return ret;
+  }
+
+  // drop a tiling only when no grouping of its iterators fits the buffers:
+  // level l and the levels below hold at least the iterator num the group
+  // search assigns them, and unlocking more iterators never shrinks a footprint
+  bool checkTileCapacity() {
+    int levelNum = _LVec.size();
+    int varNum = _coupledVarVec.size();
+    int minVarNum = 0;
+    for (int i = 0; i < levelNum; i++) {
+      if (i == levelNum - 1)
+        minVarNum = varNum;
+      else
+        minVarNum += std::max(1, _LVec[i].getSpatialDimNum());
+      if (minVarNum > varNum)
+        return false;
+      if (_LVec[i].checkIfNetworkExtended())
+        continue;
+      if (!checkMinRequiredDataSize(_LVec[i], minVarNum))
+        return false;
+    }
+    return true;
+  }
+
   // retrieve all combinations of partitioning schemes
   void combine(std::vector<TileCandidateCombine> &tileCandidateCombineVec,
                TileCandidateCombine &curCandidateCombine,
@@ -108,17 +260,46 @@ public:
     }
   }
 
-  // entry of search
-  void oneSearch(std::ofstream &logFile, bool logFlag) {
-    std::vector<TileCandidateCombine> tileCandidateCombineVec;
+  void combine(std::vector<TileCandidateCombine> &tileCandidateCombineVec) {
     TileCandidateCombine curCandidateCombine;
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> varVec;
     for (auto &item : _allIteratorCandidate) {
       varVec.push_back(item.first);
     }
-
     combine(tileCandidateCombineVec, curCandidateCombine, varVec, 0);
-    int num = varVec.size();
+  }
+
+  // tensors and iterators of the original ones split by a combination
+  void splitCombine(TileCandidateCombine &tileCandidateCombine) {
+    reset();
+    int num = tileCandidateCombine.varVec.size();
+    for (int i = 0; i < num; i++) {
+      split(tileCandidateCombine.varVec[i], tileCandidateCombine.sizeVec[i]);
+    }
+  }
+
+  int compWorkerNum() {
+    return _workerNum == 0 ? std::thread::hardware_concurrency() : _workerNum;
+  }
+
+  // the tile sizes of a combination, e.g. "k 16 c 8"
+  static std::string tileCandidateString(TileCandidateCombine &combine) {
+    std::string ret;
+    int num = combine.varVec.size();
+    for (int i = 0; i < num; i++) {
+      if (i != 0)
+        ret += ' ';
+      ret += combine.varVec[i]->getSym() + ' ' +
+             std::to_string(combine.sizeVec[i]);
+    }
+    return ret;
+  }
+
+  // entry of search
+  void oneSearch(std::ofstream &logFile, bool logFlag) {
+    TRACE_SPAN("TileSearchEngine::oneSearch");
+    std::vector<TileCandidateCombine> tileCandidateCombineVec;
+    combine(tileCandidateCombineVec);
     for (auto tileCandidateCombine : tileCandidateCombineVec) {
       // for (int i = 0; i < num; i++)
       //{
@@ -126,30 +307,103 @@ public:
       //    tileCandidateCombine.sizeVec[i] << ' ';
       //}
       // std::cout << std::endl;
-      reset();
-      for (int i = 0; i < num; i++) {
-        split(tileCandidateCombine.varVec[i], tileCandidateCombine.sizeVec[i]);
+      TRACE_SPAN("tile combination", tileCandidateString(tileCandidateCombine));
+      PROGRESS::startTile();
+      FUNNEL::count(FUNNEL::TILE_COMBINATION);
+      FUNNEL::StageTimer tileTimer(FUNNEL::TILE_STAGE);
+      splitCombine(tileCandidateCombine);
+      if (!checkTileCapacity()) {
+        FUNNEL::count(FUNNEL::TILE_REJECT_CAPACITY);
+        continue;
       }
+      tileTimer.stop();
 
-      DSE::GroupSearchEngine groupSearchEngine(_I, _W, _O, _coupledVarVec);
+      DSE::GroupSearchEngine groupSearchEngine(_I, _W, _O, _coupledVarVec,
+                                               compWorkerNum());
       for (auto &L : _LVec) {
         groupSearchEngine.addLevel(L);
       }
+      groupSearchEngine.setBeam(_beamWidth, _beamWeightVec);
+      PROGRESS::setGroupTotal(groupSearchEngine.countGroup());
       groupSearchEngine.oneSearch(logFile, logFlag);
       for (auto result : groupSearchEngine._groupSearchResult) {
         // if
         // (result->_multiLevelTransformSearchResult->_transformSearchResult[2]
         //         ->_result->delay > 10000000)
         //   continue;
-        _groupSearchResult.push_back(result);
+        addResult(result);
+      }
+      // the progress report replaces the lines of every tile combination
+      if (!PROGRESS::isRunning()) {
+        std::cout << groupSearchEngine._groupSearchResult.size() << std::endl;
+        std::cout << (_paretoObjectiveVec.empty() ? _groupSearchResult.size()
+                                                  : _paretoFront.size())
+                  << std::endl;
+        std::cout << _I.to_string() << ' ';
+        std::cout << _W.to_string() << ' ';
+        std::cout << _O.to_string() << ' ';
+        std::cout << std::endl;
+      }
+      checkSnapshot();
+    }
+    flushResult();
+  }
+
+  // size of the exhaustive search without running it: every tile
+  // combination is split and checked, its groups are counted and sampleNum
+  // of them sampled, see GroupSearchEngine::estimate
+  void estimate(SearchEstimate &estimate, int sampleNum, int evaluationNum) {
+    TRACE_SPAN("TileSearchEngine::estimate");
+    std::vector<TileCandidateCombine> tileCandidateCombineVec;
+    combine(tileCandidateCombineVec);
+    for (auto tileCandidateCombine : tileCandidateCombineVec) {
+      estimate.tileNum++;
+      splitCombine(tileCandidateCombine);
+      if (!checkTileCapacity())
+        continue;
+      estimate.validTileNum++;
+      DSE::GroupSearchEngine groupSearchEngine(_I, _W, _O, _coupledVarVec,
+                                               compWorkerNum());
+      for (auto &L : _LVec) {
+        groupSearchEngine.addLevel(L);
       }
-      std::cout << groupSearchEngine._groupSearchResult.size() << std::endl;
-      std::cout << _groupSearchResult.size() << std::endl;
-      std::cout << _I.to_string() << ' ';
-      std::cout << _W.to_string() << ' ';
-      std::cout << _O.to_string() << ' ';
-      std::cout << std::endl;
+      groupSearchEngine.estimate(estimate, sampleNum, evaluationNum);
+    }
+    reset();
+  }
+
+  // the best results so far in the format of the result files. written to
+  // a temporary file first and renamed, a reader never sees a partial one
+  void outputSnapshot() {
+    std::vector<std::shared_ptr<GroupSearchResult>> resultVec;
+    if (_paretoObjectiveVec.empty())
+      resultVec = _groupSearchResult;
+    else
+      _paretoFront.getFront(resultVec);
+    std::vector<std::pair<double, int>> scoreVec;
+    for (int i = 0; i < resultVec.size(); i++)
+      scoreVec.emplace_back(compScore(*resultVec[i], *_snapshotTarget), i);
+    int num = std::min(_snapshotNum, int(scoreVec.size()));
+    std::partial_sort(scoreVec.begin(), scoreVec.begin() + num,
+                      scoreVec.end());
+    if (num > 0)
+      PROGRESS::setBestScore(scoreVec[0].first);
+    std::string tmpName = _snapshotName + ".tmp";
+    std::ofstream ofile;
+    ofile.open(tmpName, std::ios::out);
+    ofile << "{\n";
+    for (int i = 0; i < num; i++) {
+      if (i != 0)
+        ofile << ",\n";
+      resultVec[scoreVec[i].second]->outputLog(ofile, i, _LVec.size());
     }
+    ofile << "}";
+    ofile.close();
+    std::rename(tmpName.c_str(), _snapshotName.c_str());
+  }
+  void checkSnapshot() {
+    if (!_snapshotName.empty() && PROGRESS::checkSnapshot())
+      outputSnapshot();
   }
   void oneSearch() {
     std::ofstream logFile;
@@ -181,30 +435,30 @@ public:
     else
       return false;
   }
+  // value of one target parameter, see defineTarget for the indices
+  static double getTargetValue(GroupSearchResult &r, int levelIndex,
+                               int targetIndex) {
+    std::shared_ptr<AnalyzerResult> &result =
+        r._multiLevelTransformSearchResult->_transformSearchResult[levelIndex]
+            ->_result;
+    return MultiLevelTransformSearchEngine::getTargetValue(*result,
+                                                           targetIndex);
+  }
+  static double compScore(GroupSearchResult &r, Target &target) {
+    double score = 0;
+    int levelNum = target._t.size();
+    for (int i = 0; i < levelNum; i++) {
+      for (int j = 0; j < 12; j++) {
+        if (target._t[i][j] != 0)
+          score += target._t[i][j] * getTargetValue(r, i, j);
+      }
+    }
+    return score;
+  }
   // compute score for each dataflow
   void cmpScore(Target &target) {
     for (auto &r : _groupSearchResult) {
-      std::vector<std::shared_ptr<TransformSearchResult>> &tr =
-          r->_multiLevelTransformSearchResult->_transformSearchResult;
-      r->score = 0;
-      int levelNum = target._t.size();
-      for (int i = 0; i < levelNum; i++) {
-        r->score += target._t[i][0] * tr[i]->_result->uniqueVolumn[0];
-        r->score += target._t[i][1] * tr[i]->_result->uniqueVolumn[1];
-        r->score += target._t[i][2] * tr[i]->_result->uniqueVolumn[2];
-        r->score += target._t[i][3] * tr[i]->_result->requiredDataSize[0];
-        r->score += target._t[i][4] * tr[i]->_result->requiredDataSize[1];
-        r->score += target._t[i][5] * tr[i]->_result->requiredDataSize[2];
-        r->score += target._t[i][6] * tr[i]->_result->requiredBandWidth[0];
-        r->score += target._t[i][7] * tr[i]->_result->requiredBandWidth[1];
-        r->score += target._t[i][8] * tr[i]->_result->requiredBandWidth[2];
-        r->score += target._t[i][9] * tr[i]->_result->delay;
-        r->score +=
-            target._t[i][10] * (tr[i]->_result->accumulateEnergy / 1000000000 +
-                                tr[i]->_result->accumulateLeakagePower *
-                                    tr[i]->_result->delay / 200000000);
-        r->score += target._t[i][11] * tr[i]->_result->accumulateArea / 1000000;
-      }
+      r->score = compScore(*r, target);
     }
   }
   void sortResult(Target &target) {
@@ -232,8 +486,34 @@ public:
     }
   }
 
+  // the frontier is already in ascending order of the first objective and
+  // is output as a whole
+  void outputParetoFront(std::ofstream &ofile, std::ofstream &ofile2,
+                         Target &target) {
+    cmpScore(target);
+    std::cout << _groupSearchResult.size() << std::endl;
+    for (auto ofs : {&ofile, &ofile2}) {
+      *ofs << "{\n";
+      for (int i = 0; i < _groupSearchResult.size(); i++) {
+        if (i != 0)
+          *ofs << ",\n";
+        _groupSearchResult[i]->outputLog(*ofs, i, _LVec.size());
+      }
+      *ofs << "}";
+    }
+  }
+
   void outputTopResult(std::ofstream &ofile, std::ofstream &ofile2,
                        Target &target, int num = 5) {
+    if (_groupSearchResult.empty()) {
+      ofile << "{}";
+      ofile2 << "{}";
+      return;
+    }
+    if (!_paretoObjectiveVec.empty()) {
+      outputParetoFront(ofile, ofile2, target);
+      return;
+    }
     int levelSize =
         _groupSearchResult[0]
             ->_multiLevelTransformSearchResult->_transformSearchResult.size();
@@ -289,6 +569,15 @@ public:
     target.addTarget(levelNum - 1, 9, 1);
     outputTopResult(ofile, ofile2, target, 5);
   }
-  double getTopScore() { return _groupSearchResult[0]->score; }
+  void getResult(std::vector<std::shared_ptr<GroupSearchResult>> &resultVec) {
+    resultVec = _groupSearchResult;
+  }
+  // the frontier is not sorted by score, no result scores infinity
+  double getTopScore() {
+    double score = std::numeric_limits<double>::infinity();
+    for (auto &r : _groupSearchResult)
+      score = std::min(score, r->score);
+    return score;
+  }
 };
 } // namespace DSE
\ No newline at end of file
@@ -1,31 +1,114 @@
 #pragma once
+#include "include/analysis/capacityAnalysis.h"
 #include "include/analysis/multiLevelAnalysis.h"
 #include "include/datastruct/arch.h"
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/workload.h"
 #include "include/util/config.h"
 #include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <numeric>
 #include <thread>
 
 namespace DSE {
+// time spent in the multi thread generateAllTransformMatrix, summed over its
+// calls. only the calling thread writes it, the workers report through
+// MultiThreadArgs
+struct TransformThreadStat {
+  long long callNum;
+  long long threadNum;
+  double totalTime;
+  // spawning the workers and waiting for the last of them
+  double createTime;
+  double joinTime;
+  // the sum and the max of the time every worker of a call runs, and the
+  // sum of their cpu time which unlike the former does not grow with more
+  // workers than cores
+  double busyTime;
+  double maxBusyTime;
+  double cpuTime;
+  TransformThreadStat() { reset(); }
+  void reset() {
+    callNum = 0;
+    threadNum = 0;
+    totalTime = 0;
+    createTime = 0;
+    joinTime = 0;
+    busyTime = 0;
+    maxBusyTime = 0;
+    cpuTime = 0;
+  }
+};
+// the search space a dry run measures on the sampled groups and projects to
+// all of them, see TileSearchEngine::estimate
+struct SearchEstimate {
+  long long tileNum;
+  // tile combinations passing checkTileCapacity
+  long long validTileNum;
+  long long groupNum;
+  long long sampledGroupNum;
+  // projected oneAnalysis calls of an exhaustive search and seconds of
+  // checking the groups and generating their transform matrices
+  double evaluationNum;
+  double transformTime;
+  // evaluations timed to calibrate the cost of one
+  long long sampledEvaluationNum;
+  double sampledEvaluationTime;
+  SearchEstimate() {
+    tileNum = 0;
+    validTileNum = 0;
+    groupNum = 0;
+    sampledGroupNum = 0;
+    evaluationNum = 0;
+    transformTime = 0;
+    sampledEvaluationNum = 0;
+    sampledEvaluationTime = 0;
+  }
+  void merge(SearchEstimate &estimate) {
+    tileNum += estimate.tileNum;
+    validTileNum += estimate.validTileNum;
+    groupNum += estimate.groupNum;
+    sampledGroupNum += estimate.sampledGroupNum;
+    evaluationNum += estimate.evaluationNum;
+    transformTime += estimate.transformTime;
+    sampledEvaluationNum += estimate.sampledEvaluationNum;
+    sampledEvaluationTime += estimate.sampledEvaluationTime;
+  }
+  double compEvaluationCost() {
+    return sampledEvaluationNum > 0
+               ? sampledEvaluationTime / sampledEvaluationNum
+               : 0;
+  }
+  double compTime() {
+    return transformTime + evaluationNum * compEvaluationCost();
+  }
+};
 // args for multi thread
 struct MultiThreadArgs {
-  std::vector<int> _permute;
+  std::vector<std::vector<int>> &_permuteVec;
   int _spatialDimNum;
   std::vector<std::shared_ptr<WORKLOAD::Iterator>> &_coupledVarVec;
   int _level;
-  std::vector<MAPPING::Transform> &_TVec;
-  long long &_count;
+  std::vector<std::vector<MAPPING::Transform>> &_TVecVec;
+  std::vector<long long> &_countVec;
   MultLevelAnalyzer &_multanalysis;
+  int _step;
+  int _stride;
+  // seconds the worker ran and was on a cpu, indexed by step
+  std::vector<double> &_busyTimeVec;
+  std::vector<double> &_cpuTimeVec;
   MultiThreadArgs(
-      std::vector<int> permute, int spatialDimNum,
+      std::vector<std::vector<int>> &permuteVec, int spatialDimNum,
       std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
-      int level, std::vector<MAPPING::Transform> &TVec, long long &count,
-      MultLevelAnalyzer &multanalysis)
-      : _permute(permute), _spatialDimNum(spatialDimNum),
-        _coupledVarVec(coupledVarVec), _TVec(TVec), _count(count),
-        _multanalysis(multanalysis), _level(level) {}
+      int level, std::vector<std::vector<MAPPING::Transform>> &TVecVec,
+      std::vector<long long> &countVec, MultLevelAnalyzer &multanalysis,
+      int step, int stride, std::vector<double> &busyTimeVec,
+      std::vector<double> &cpuTimeVec)
+      : _permuteVec(permuteVec), _spatialDimNum(spatialDimNum),
+        _coupledVarVec(coupledVarVec), _level(level), _TVecVec(TVecVec),
+        _countVec(countVec), _multanalysis(multanalysis), _step(step),
+        _stride(stride), _busyTimeVec(busyTimeVec), _cpuTimeVec(cpuTimeVec) {}
 };
 void generateAllTransformMatrixMultiThread(MultiThreadArgs args);
 class TransformSearchEngine {
@@ -35,13 +118,16 @@ private:
   int _spatialDimNum;
   std::vector<MAPPING::Transform> _TVec;
   int _TVecIndex;
+  MEMORY::Usage _TVecUsage;
 
 public:
   static long long totalCount;
+  static TransformThreadStat threadStat;
   TransformSearchEngine(
       std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
       ARCH::Level &L, int spatialDimNum, int preCoupledNum)
-      : _coupledVarVec(coupledVarVec), _L(L), _spatialDimNum(spatialDimNum)
+      : _coupledVarVec(coupledVarVec), _L(L), _spatialDimNum(spatialDimNum),
+        _TVecUsage(MEMORY::TRANSFORM)
 
   {
     assert(_coupledVarVec.size() >= _spatialDimNum);
@@ -79,6 +165,11 @@ public:
                          _TVec[_TVecIndex], false);
   }
   bool isEmpty() { return _TVec.size() == 0; }
+  int getTNum() { return _TVec.size(); }
+  void setIndex(int index) {
+    assert(index < _TVec.size());
+    _TVecIndex = index;
+  }
 };
 // transformSearchEngine will generate all possible transform matrices
 // and the generator will enumerate and analyze them one by one
@@ -96,8 +187,12 @@ public:
     }
     return true;
   }
+  // the top level advances fastest, the results of the levels below are
+  // then reused by MultLevelAnalyzer until a lower level advances
   void getNext() {
-    for (auto &transformSearchEngine : _transformSearchEngineSet) {
+    for (auto it = _transformSearchEngineSet.rbegin();
+         it != _transformSearchEngineSet.rend(); it++) {
+      auto &transformSearchEngine = *it;
       if (transformSearchEngine.isTop()) {
         transformSearchEngine.getNext();
       } else {
@@ -118,6 +213,45 @@ public:
     return true;
   }
 };
+// analyzers kept across the groups of one group search, one for
+// checkRequiredDataSize and oneAnalysis plus one per transform worker
+class AnalyzerPool {
+  WORKLOAD::Tensor &_I;
+  WORKLOAD::Tensor &_W;
+  WORKLOAD::Tensor &_O;
+  int _workerNum;
+  MultLevelAnalyzer _multanalysis;
+  std::vector<MultLevelAnalyzer> _multanalysisVec;
+  MEMORY::Usage _usage;
+
+public:
+  AnalyzerPool(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W, WORKLOAD::Tensor &O,
+               int workerNum = std::thread::hardware_concurrency())
+      : _I(I), _W(W), _O(O), _workerNum(std::max(1, workerNum)),
+        _multanalysis(I, W, O), _usage(MEMORY::ANALYZER) {}
+  int getWorkerNum() { return _workerNum; }
+  MultLevelAnalyzer &getMainAnalyzer() {
+    _multanalysis.reset();
+    return _multanalysis;
+  }
+  // no more workers than the largest level has permutation roots
+  std::vector<MultLevelAnalyzer> &getWorkerAnalyzers(int maxDimNum) {
+    int num = std::min(_workerNum, std::max(1, maxDimNum));
+    while (_multanalysisVec.size() < num)
+      _multanalysisVec.emplace_back(_I, _W, _O);
+    for (auto &multanalysis : _multanalysisVec)
+      multanalysis.reset();
+    return _multanalysisVec;
+  }
+  // count the analyzers as the last group left them, the caches are only
+  // cleared by the next group
+  void updateUsage() {
+    long long bytes = _multanalysis.compMemoryBytes();
+    for (auto &multanalysis : _multanalysisVec)
+      bytes += multanalysis.compMemoryBytes();
+    _usage.set(bytes);
+  }
+};
 // traverse through all transform matrices for each hardware level
 class MultiLevelTransformSearchEngine {
   WORKLOAD::Tensor &_I;
@@ -125,13 +259,48 @@ class MultiLevelTransformSearchEngine {
   WORKLOAD::Tensor &_O;
   std::vector<TransformSearchEngine> _transformSearchEngineSet;
   int _countCoupledVar;
+  int _maxCoupledVar;
   std::vector<std::shared_ptr<MultiLevelTransformSearchResult>> _mltsResult;
+  CAPACITY::CapacityChecker _capacityChecker;
+  AnalyzerPool &_analyzerPool;
+  // 0 means the whole product of the transform matrices of every level
+  int _beamWidth;
+  // target weight of every target index, summed over the levels
+  std::vector<double> _beamWeightVec;
+
+  double compPartialScore(AnalyzerResult &result);
+  void beamSearch(MultLevelAnalyzer &multanalysis, std::ofstream &logFile,
+                  bool logFlag);
 
 public:
   static long long _resultCount;
   MultiLevelTransformSearchEngine(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
-                                  WORKLOAD::Tensor &O)
-      : _I(I), _W(W), _O(O), _countCoupledVar(0) {}
+                                  WORKLOAD::Tensor &O,
+                                  AnalyzerPool &analyzerPool)
+      : _I(I), _W(W), _O(O), _countCoupledVar(0), _maxCoupledVar(0),
+        _capacityChecker(I, W, O), _analyzerPool(analyzerPool),
+        _beamWidth(0) {}
+
+  void setBeam(int beamWidth, std::vector<double> &beamWeightVec) {
+    _beamWidth = beamWidth;
+    _beamWeightVec = beamWeightVec;
+  }
+
+  // value of one target index of Target::addTarget
+  static double getTargetValue(AnalyzerResult &result, int targetIndex) {
+    if (targetIndex < 3)
+      return result.uniqueVolumn[targetIndex];
+    if (targetIndex < 6)
+      return result.requiredDataSize[targetIndex - 3];
+    if (targetIndex < 9)
+      return result.requiredBandWidth[targetIndex - 6];
+    if (targetIndex == 9)
+      return result.delay;
+    if (targetIndex == 10)
+      return result.accumulateEnergy / 1000000000 +
+             result.accumulateLeakagePower * result.delay / 200000000;
+    return result.accumulateArea / 1000000;
+  }
 
   void addLevel(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
                 ARCH::Level &L) {
@@ -139,15 +308,24 @@ public:
     _transformSearchEngineSet.emplace_back(coupledVarVec, L, spatialDimNum,
                                            _countCoupledVar);
     _countCoupledVar += coupledVarVec.size();
+    _maxCoupledVar = std::max(_maxCoupledVar, int(coupledVarVec.size()));
+    _capacityChecker.addLevel(coupledVarVec, L);
   }
 
-  void oneSearch(std::ofstream &logFile, bool logFlag) {
+  // size the analyzers for the group and generate the transform matrices of
+  // every level, null if the group overflows a buffer or a level has none
+  MultLevelAnalyzer *generateTransform() {
+    FUNNEL::count(FUNNEL::GROUP);
+    FUNNEL::StageTimer groupTimer(FUNNEL::GROUP_STAGE);
+    // reject groups that overflow a buffer before any analyzer is built
+    if (!_capacityChecker.checkRequiredDataSize()) {
+      FUNNEL::count(FUNNEL::GROUP_REJECT_CAPACITY);
+      return nullptr;
+    }
     // multi level analysis for multi thread generateAllTransformMatrix
-    std::vector<MultLevelAnalyzer> multanalysisVec;
-    for (int i = 0; i < _countCoupledVar; i++)
-      multanalysisVec.emplace_back(_I, _W, _O);
-    // for checkRequiredDataSize only, never start oneAnalysis
-    MultLevelAnalyzer multanalysis(_I, _W, _O);
+    std::vector<MultLevelAnalyzer> &multanalysisVec =
+        _analyzerPool.getWorkerAnalyzers(_maxCoupledVar);
+    MultLevelAnalyzer &multanalysis = _analyzerPool.getMainAnalyzer();
     int levelNum = _transformSearchEngineSet.size();
 
     for (int i = 0; i < levelNum; i++) {
@@ -156,31 +334,91 @@ public:
       for (auto &oneMultanalysis : multanalysisVec)
         transformSearchEngine.addLevel(oneMultanalysis);
     }
-    if (!multanalysis.checkRequiredDataSize())
-      return;
+    // never fails after the size-only check, still run to size the free
+    // buffers and set the required data size of every level
+    if (!multanalysis.checkRequiredDataSize()) {
+      FUNNEL::count(FUNNEL::GROUP_REJECT_CAPACITY);
+      return nullptr;
+    }
+    groupTimer.stop();
 
+    FUNNEL::StageTimer transformTimer(FUNNEL::TRANSFORM_STAGE);
     for (int i = 0; i < levelNum; i++) {
       auto &transformSearchEngine = _transformSearchEngineSet[i];
       transformSearchEngine.generateAllTransformMatrix(i, multanalysis,
                                                        multanalysisVec);
     }
+    transformTimer.stop();
 
     Generator generator(_transformSearchEngineSet);
     if (!generator.isValid())
+      return nullptr;
+    return &multanalysis;
+  }
+
+  void oneSearch(std::ofstream &logFile, bool logFlag) {
+    TRACE_SPAN("MultiLevelTransformSearchEngine::oneSearch");
+    MultLevelAnalyzer *multanalysis = generateTransform();
+    if (multanalysis == nullptr)
+      return;
+    Generator generator(_transformSearchEngineSet);
+
+    FUNNEL::StageTimer analysisTimer(FUNNEL::ANALYSIS_STAGE);
+
+    if (_beamWidth > 0) {
+      beamSearch(*multanalysis, logFile, logFlag);
       return;
+    }
 
     int count = 0;
     int firstFlag = true;
     while (!generator.isEnd()) {
-      generator.startAnalysis(multanalysis, _mltsResult, count++, logFile,
+      generator.startAnalysis(*multanalysis, _mltsResult, count++, logFile,
                               logFlag, firstFlag);
       generator.getNext();
       firstFlag = false;
     }
-    generator.startAnalysis(multanalysis, _mltsResult, count++, logFile,
+    generator.startAnalysis(*multanalysis, _mltsResult, count++, logFile,
                             logFlag, firstFlag);
   }
 
+  // the transform matrices of the group are generated as by oneSearch, their
+  // combinations counted and only the first evaluationNum of them analyzed
+  // to time one evaluation. the beam is not taken into account
+  void estimate(SearchEstimate &estimate, int evaluationNum) {
+    TRACE_SPAN("MultiLevelTransformSearchEngine::estimate");
+    estimate.sampledGroupNum++;
+    auto start = std::chrono::steady_clock::now();
+    MultLevelAnalyzer *multanalysis = generateTransform();
+    estimate.transformTime += std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+    if (multanalysis == nullptr)
+      return;
+    double combinationNum = 1;
+    for (auto &transformSearchEngine : _transformSearchEngineSet)
+      combinationNum *= transformSearchEngine.getTNum();
+    estimate.evaluationNum += combinationNum;
+
+    std::ofstream logFile;
+    Generator generator(_transformSearchEngineSet);
+    int count = 0;
+    start = std::chrono::steady_clock::now();
+    while (count < evaluationNum) {
+      generator.startAnalysis(*multanalysis, _mltsResult, count++, logFile,
+                              false, false);
+      if (generator.isEnd())
+        break;
+      generator.getNext();
+    }
+    estimate.sampledEvaluationTime +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start)
+            .count();
+    estimate.sampledEvaluationNum += count;
+    _mltsResult.clear();
+  }
+
   static bool
   cmpResultByTotalCycle(std::shared_ptr<MultiLevelTransformSearchResult> &r1,
                         std::shared_ptr<MultiLevelTransformSearchResult> &r2) {
@@ -3,6 +3,7 @@
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/workload.h"
 #include "include/util/debug.h"
+#include <set>
 #include <string>
 #include <vector>
 struct Task {
@@ -26,6 +27,31 @@ struct Task {
     return std::make_shared<WORKLOAD::Polynomial>(iterator);
   }
 
+  // add the divisors of every iterator range to its candidates, with
+  // nearDivisorFlag also the smallest tile size of every tile count, which
+  // leaves an edge tile
+  void defineAutoCandidate(bool nearDivisorFlag = false) {
+    for (auto &p : _allIteratorCandidate) {
+      int range = p.first->getUpBound() - p.first->getLowBound() + 1;
+      std::set<int> candidateSet(p.second.begin(), p.second.end());
+      for (int i = 1; i * i <= range; i++) {
+        if (range % i == 0) {
+          candidateSet.insert(i);
+          candidateSet.insert(range / i);
+        }
+      }
+      if (nearDivisorFlag) {
+        for (int tileNum = 1; tileNum <= range; tileNum++) {
+          candidateSet.insert((range + tileNum - 1) / tileNum);
+        }
+      }
+      // a tile of 1 only adds a degenerate iterator
+      if (range > 1)
+        candidateSet.erase(1);
+      p.second = std::vector<int>(candidateSet.begin(), candidateSet.end());
+    }
+  }
+
   void
   defineTensor(ARCH::DATATYPE dataType, std::string sym,
                std::vector<std::shared_ptr<WORKLOAD::Polynomial>> polyVec) {
@@ -173,6 +199,8 @@ struct AcceleratorSet {
 
 struct Target {
   std::vector<std::vector<double>> _t;
+  // (levelIndex, targetIndex) of every objective of the pareto mode
+  std::vector<std::pair<int, int>> _paretoObjectiveVec;
   bool _flag;
   Target(AcceleratorSet &accSet)
       : _t(std::vector<std::vector<double>>(
@@ -186,10 +214,88 @@ struct Target {
     _t[levelIndex][targetIndex] = ratio;
     _flag = true;
   }
+  // keep the non-dominated results over the objectives instead of the top
+  // weighted sum, same indices as addTarget
+  void addParetoObjective(int levelIndex, int targetIndex) {
+    DEBUG::check(levelIndex < _t.size() && targetIndex < 12,
+                 DEBUG::ERROR_OPTION, "Target::addParetoObjective");
+    _paretoObjectiveVec.emplace_back(levelIndex, targetIndex);
+    _flag = true;
+  }
+  bool checkIfPareto() { return !_paretoObjectiveVec.empty(); }
   void check() { DEBUG::check(_flag, DEBUG::EMPTY_TARGET, "Target::check"); }
 };
 
-void defineTaskSet(TaskSet &taskset);
+enum SEARCHMODE { EXHAUSTIVE, ANNEALING, RANDOMSAMPLE, GENETIC };
+
+// command line options of the search
+struct SearchOption {
+  SEARCHMODE _mode;
+  // proposals of the stochastic search
+  long long _budget;
+  unsigned int _seed;
+  // 0 means hardware concurrency
+  int _threadNum;
+  int _populationNum;
+  // beam width of the transform search across levels, 0 means exhaustive
+  int _beamWidth;
+  // tasks of defineTaskSet
+  std::string _workloadPack;
+  // bytes the counted search structures may use, see MEMORY::Category. 0
+  // means no limit
+  long long _memLimit;
+  // seconds between the memory reports, 0 means none
+  double _memReportInterval;
+  // hardware counters of PERF, written to perf.json
+  bool _perfFlag;
+  // seconds between the progress reports and snapshots, 0 means none
+  double _progressInterval;
+  std::string _snapshotName;
+  // estimate the size and runtime of the search instead of running it,
+  // sampling _dryRunSampleNum groups of every tile combination
+  bool _dryRunFlag;
+  int _dryRunSampleNum;
+  // tile candidates of every task from the divisors of its iterator ranges,
+  // with _nearDivisorFlag also the near divisors, see
+  // Task::defineAutoCandidate
+  bool _autoTileFlag;
+  bool _nearDivisorFlag;
+  // (levelIndex, targetIndex) of every objective of the pareto mode, they
+  // replace the targets of defineTarget, see Target::addParetoObjective
+  std::vector<std::pair<int, int>> _paretoObjectiveVec;
+  SearchOption()
+      : _mode(EXHAUSTIVE), _budget(2000), _seed(0), _threadNum(0),
+        _populationNum(32), _beamWidth(0), _workloadPack("alexnet"),
+        _memLimit(0), _memReportInterval(0), _perfFlag(false),
+        _progressInterval(0), _snapshotName("snapshot.json"),
+        _dryRunFlag(false), _dryRunSampleNum(4), _autoTileFlag(false),
+        _nearDivisorFlag(false) {}
+};
+
+void parseSearchOption(int argc, char **argv, SearchOption &option);
+// the number of an option value, a malformed or out of range one is an
+// ERROR_OPTION of arg
+long long parseIntegerOption(std::string arg, std::string value,
+                             long long minValue = INT_MIN,
+                             long long maxValue = INT_MAX);
+double parseDoubleOption(std::string arg, std::string value);
+
+// tasks of the shapes below, parameterized by their dimensions. the tile
+// candidates of every iterator are the divisors of its range
+void defineBatchedGemmTask(TaskSet &taskset, int b, int m, int n, int k);
+void defineConvTask(TaskSet &taskset, int k, int c, int h, int w, int r,
+                    int s, int n, int stride = 1);
+void defineDepthwiseConvTask(TaskSet &taskset, int c, int h, int w, int r,
+                             int s, int n, int stride = 1);
+void definePointwiseConvTask(TaskSet &taskset, int k, int c, int h, int w,
+                             int n);
+void defineAttentionQKTask(TaskSet &taskset, int b, int seqLen, int headDim);
+void defineAttentionAVTask(TaskSet &taskset, int b, int seqLen, int headDim);
+
+bool checkWorkloadPack(std::string workloadPack);
+
+void defineTaskSet(TaskSet &taskset, std::string workloadPack = "alexnet",
+                   bool autoTileFlag = false, bool nearDivisorFlag = false);
 
 void defineTarget(Target &target);
 
@@ -25,7 +25,10 @@ typedef enum {
   EMPTY_TARGET,
   ERROR_ACCELERATOR_SET,
   EMPTY_ACCELERATOR_SET,
-  NETWORK_FEATURE_ERROR
+  NETWORK_FEATURE_ERROR,
+  ERROR_OPTION,
+  MEMORY_LIMIT,
+  FILE_ERROR
 } ErrorType;
 template <typename T> std::string vec2string(std::vector<T> &vec) {
   std::string ret;
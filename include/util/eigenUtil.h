@@ -3,6 +3,7 @@
 #include "Eigen/Dense"
 #include "include/datastruct/mapping.h"
 #include "include/util/debug.h"
+#include "include/util/perf.h"
 typedef double valueType;
 
 void printMatrix(
@@ -69,6 +70,10 @@ struct Fraction {
 
 void compATinv(MAPPING::Transform &T, MAPPING::Access &A,
                std::vector<std::vector<int>> &matrix);
+// compATinv for any size of transform matrix, compATinv takes it for the
+// sizes without a fixed size one
+void compATinvGeneric(MAPPING::Transform &T, MAPPING::Access &A,
+                      std::vector<std::vector<int>> &matrix);
 
 std::pair<int, int>
 findFirstNoZeroRow(std::vector<std::vector<Fraction>> &matrix, int startRow);
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <fstream>
+#include <string>
+namespace FUNNEL {
+// how many candidates reach every stage of the search and why the others
+// are dropped
+typedef enum {
+  // tilings of TileSearchEngine and those checkTileCapacity drops
+  TILE_COMBINATION,
+  TILE_REJECT_CAPACITY,
+  // groupings of the iterators to the levels and those overflowing a buffer
+  GROUP,
+  GROUP_REJECT_CAPACITY,
+  // transform matrices tried by changeT, split by the reason of rejection
+  TRANSFORM,
+  TRANSFORM_REJECT_CHECK,
+  TRANSFORM_REJECT_PE,
+  TRANSFORM_REJECT_NETWORK_REUSE,
+  // MultLevelAnalyzer::oneAnalysis calls and those of an invalid level
+  ANALYSIS,
+  ANALYSIS_FAIL,
+  COUNTER_NUM
+} Counter;
+
+typedef enum {
+  TILE_STAGE,
+  GROUP_STAGE,
+  TRANSFORM_STAGE,
+  ANALYSIS_STAGE,
+  STAGE_NUM
+} Stage;
+
+struct Funnel {
+  long long counter[COUNTER_NUM];
+  // wall seconds of every stage in the threads that ran it
+  double time[STAGE_NUM];
+  Funnel() { reset(); }
+  void reset() {
+    for (int i = 0; i < COUNTER_NUM; i++)
+      counter[i] = 0;
+    for (int i = 0; i < STAGE_NUM; i++)
+      time[i] = 0;
+  }
+  void merge(Funnel &funnel) {
+    for (int i = 0; i < COUNTER_NUM; i++)
+      counter[i] += funnel.counter[i];
+    for (int i = 0; i < STAGE_NUM; i++)
+      time[i] += funnel.time[i];
+  }
+};
+
+// every thread counts into its own funnel, which is merged into the total
+// when the thread exits
+void count(Counter counter, long long num = 1);
+void addTime(Stage stage, double time);
+// the funnels of the exited threads and of the calling thread
+void getTotal(Funnel &total);
+void reset();
+void outputJSON(std::string name);
+
+// adds the time from its construction to stop or its destruction
+class StageTimer {
+  Stage _stage;
+  bool _runFlag;
+  std::chrono::steady_clock::time_point _start;
+
+public:
+  StageTimer(Stage stage)
+      : _stage(stage), _runFlag(true),
+        _start(std::chrono::steady_clock::now()) {}
+  void stop() {
+    if (!_runFlag)
+      return;
+    _runFlag = false;
+    addTime(_stage, std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - _start)
+                        .count());
+  }
+  ~StageTimer() { stop(); }
+};
+} // namespace FUNNEL
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <string>
+namespace MEMORY {
+// estimated bytes of the data structures that grow with the search space,
+// counted explicitly where they are built and freed
+typedef enum {
+  // transform matrices kept by every TransformSearchEngine
+  TRANSFORM,
+  // pooled MultLevelAnalyzers of the transform workers and their caches
+  ANALYZER,
+  // AnalyzerResults and their activate count maps held by the results
+  ANALYZER_RESULT,
+  // GroupSearchResult trees kept until outputLog
+  GROUP_RESULT,
+  CATEGORY_NUM
+} Category;
+
+// the search exits with an error once the total exceeds limit, 0 for none
+void setLimit(long long limit);
+// report the usage on stderr every interval seconds from tick, 0 for never
+void setReportInterval(double interval);
+void add(Category category, long long bytes);
+long long getCurrent(Category category);
+long long getPeak(Category category);
+// called between units of work, reports once the interval has passed
+void tick();
+void report();
+void outputJSON(std::string name);
+
+// bytes of one owner, counted while the owner is alive. a copy counts the
+// bytes again
+class Usage {
+  Category _category;
+  long long _bytes;
+
+public:
+  Usage(Category category) : _category(category), _bytes(0) {}
+  Usage(const Usage &other) : _category(other._category), _bytes(0) {
+    set(other._bytes);
+  }
+  Usage &operator=(const Usage &other) {
+    set(0);
+    _category = other._category;
+    set(other._bytes);
+    return *this;
+  }
+  ~Usage() { set(0); }
+  void set(long long bytes) {
+    if (bytes != _bytes)
+      add(_category, bytes - _bytes);
+    _bytes = bytes;
+  }
+};
+
+// a map node is its value and the three links and color of the tree
+template <typename T> long long compMapBytes(T &map) {
+  return sizeof(T) + map.size() * (sizeof(typename T::value_type) + 32);
+}
+} // namespace MEMORY
@@ -0,0 +1,248 @@
+#pragma once
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+// streaming non-dominated set, every objective is minimized
+// with two objectives the points are kept sorted by the first objective as a
+// staircase whose second objective strictly decreases, so one lookup decides
+// dominance and the dominated points form one contiguous run
+// with three or more the points are kept in a k-d tree whose nodes hold the
+// box of their subtree, the dominance query only walks the subtrees whose
+// lower corner is no worse than the point and the removal the ones whose
+// upper corner is no better
+template <typename T> class ParetoFront {
+  struct Node {
+    std::vector<double> objective;
+    T item;
+    // insertion order, equal first objectives keep it in getFront
+    long long order;
+    bool alive;
+    int left;
+    int right;
+    // nodes of the subtree, removed ones included
+    int size;
+    std::vector<double> low;
+    std::vector<double> up;
+  };
+
+  int _objectiveNum;
+  std::multimap<double, std::pair<std::vector<double>, T>> _front;
+  // removed points stay in the tree until they outnumber the live ones
+  std::vector<Node> _nodeVec;
+  int _root;
+  int _aliveNum;
+  long long _orderCount;
+
+  // a is no worse than b in every objective
+  static bool weaklyDominate(const std::vector<double> &a,
+                             const std::vector<double> &b) {
+    int num = a.size();
+    for (int i = 0; i < num; i++) {
+      if (a[i] > b[i])
+        return false;
+    }
+    return true;
+  }
+
+  bool insert2D(std::vector<double> &objective, T &item) {
+    auto it = _front.upper_bound(objective[0]);
+    if (it != _front.begin() &&
+        std::prev(it)->second.first[1] <= objective[1])
+      return false;
+    it = _front.lower_bound(objective[0]);
+    while (it != _front.end() && it->second.first[1] >= objective[1])
+      it = _front.erase(it);
+    _front.emplace_hint(it, objective[0], std::make_pair(objective, item));
+    return true;
+  }
+
+  int getSize(int node) { return node < 0 ? 0 : _nodeVec[node].size; }
+
+  // size and box of a node from its children
+  void pull(int node) {
+    Node &n = _nodeVec[node];
+    n.size = 1;
+    n.low = n.objective;
+    n.up = n.objective;
+    for (int child : {n.left, n.right}) {
+      if (child < 0)
+        continue;
+      n.size += _nodeVec[child].size;
+      for (int i = 0; i < _objectiveNum; i++) {
+        n.low[i] = std::min(n.low[i], _nodeVec[child].low[i]);
+        n.up[i] = std::max(n.up[i], _nodeVec[child].up[i]);
+      }
+    }
+  }
+
+  // balanced subtree of idVec[begin, end), split on objective depth % num
+  int build(std::vector<int> &idVec, int begin, int end, int depth) {
+    if (begin >= end)
+      return -1;
+    int axis = depth % _objectiveNum;
+    int mid = (begin + end) / 2;
+    std::nth_element(idVec.begin() + begin, idVec.begin() + mid,
+                     idVec.begin() + end, [this, axis](int a, int b) {
+                       return _nodeVec[a].objective[axis] <
+                              _nodeVec[b].objective[axis];
+                     });
+    int node = idVec[mid];
+    _nodeVec[node].left = build(idVec, begin, mid, depth + 1);
+    _nodeVec[node].right = build(idVec, mid + 1, end, depth + 1);
+    pull(node);
+    return node;
+  }
+
+  void collectAlive(int node, std::vector<int> &idVec) {
+    if (node < 0)
+      return;
+    collectAlive(_nodeVec[node].left, idVec);
+    if (_nodeVec[node].alive)
+      idVec.push_back(node);
+    collectAlive(_nodeVec[node].right, idVec);
+  }
+
+  // drop the removed nodes and rebuild the whole tree
+  void compact() {
+    std::vector<Node> nodeVec;
+    for (auto &node : _nodeVec) {
+      if (node.alive)
+        nodeVec.push_back(std::move(node));
+    }
+    _nodeVec.swap(nodeVec);
+    std::vector<int> idVec(_nodeVec.size());
+    for (int i = 0; i < idVec.size(); i++)
+      idVec[i] = i;
+    _root = build(idVec, 0, idVec.size(), 0);
+  }
+
+  // rebuild the subtree of path[index], the sizes and boxes above it shrink
+  // by its removed nodes
+  void rebuild(std::vector<int> &path, int index) {
+    std::vector<int> idVec;
+    collectAlive(path[index], idVec);
+    int node = build(idVec, 0, idVec.size(), index);
+    if (index == 0) {
+      _root = node;
+      return;
+    }
+    Node &parent = _nodeVec[path[index - 1]];
+    (parent.left == path[index] ? parent.left : parent.right) = node;
+    for (int i = index - 1; i >= 0; i--)
+      pull(path[i]);
+  }
+
+  bool findDominator(int node, std::vector<double> &objective) {
+    if (node < 0 || !weaklyDominate(_nodeVec[node].low, objective))
+      return false;
+    if (_nodeVec[node].alive &&
+        weaklyDominate(_nodeVec[node].objective, objective))
+      return true;
+    return findDominator(_nodeVec[node].left, objective) ||
+           findDominator(_nodeVec[node].right, objective);
+  }
+
+  void removeDominated(int node, std::vector<double> &objective) {
+    if (node < 0 || !weaklyDominate(objective, _nodeVec[node].up))
+      return;
+    if (_nodeVec[node].alive &&
+        weaklyDominate(objective, _nodeVec[node].objective)) {
+      _nodeVec[node].alive = false;
+      _aliveNum--;
+    }
+    removeDominated(_nodeVec[node].left, objective);
+    removeDominated(_nodeVec[node].right, objective);
+  }
+
+  bool insertND(std::vector<double> &objective, T &item) {
+    if (findDominator(_root, objective))
+      return false;
+    removeDominated(_root, objective);
+    if (_nodeVec.size() > 2 * _aliveNum + 64)
+      compact();
+    int id = _nodeVec.size();
+    _nodeVec.push_back(
+        {objective, item, _orderCount++, true, -1, -1, 1, objective, objective});
+    _aliveNum++;
+    if (_root < 0) {
+      _root = id;
+      return true;
+    }
+    std::vector<int> path;
+    int node = _root;
+    while (node != id) {
+      path.push_back(node);
+      Node &n = _nodeVec[node];
+      n.size++;
+      for (int i = 0; i < _objectiveNum; i++) {
+        n.low[i] = std::min(n.low[i], objective[i]);
+        n.up[i] = std::max(n.up[i], objective[i]);
+      }
+      int axis = (path.size() - 1) % _objectiveNum;
+      int &child = objective[axis] < n.objective[axis] ? n.left : n.right;
+      if (child < 0)
+        child = id;
+      node = child;
+    }
+    // scapegoat: a path longer than log_{1/0.7} of the tree rebuilds the
+    // lowest subtree above the new node with a child over 0.7 of it
+    if (path.size() > std::log(_nodeVec.size()) / std::log(1 / 0.7) + 1) {
+      for (int i = path.size() - 1; i >= 0; i--) {
+        Node &n = _nodeVec[path[i]];
+        if (std::max(getSize(n.left), getSize(n.right)) > 0.7 * n.size) {
+          rebuild(path, i);
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+public:
+  ParetoFront(int objectiveNum = 2)
+      : _objectiveNum(objectiveNum), _root(-1), _aliveNum(0),
+        _orderCount(0) {}
+
+  // return false if the point is weakly dominated and dropped, equal points
+  // keep the first one
+  bool insert(std::vector<double> &objective, T item) {
+    assert(objective.size() == _objectiveNum);
+    if (_objectiveNum == 2)
+      return insert2D(objective, item);
+    return insertND(objective, item);
+  }
+
+  int size() { return _objectiveNum == 2 ? _front.size() : _aliveNum; }
+  bool empty() { return size() == 0; }
+  void clear() {
+    _front.clear();
+    _nodeVec.clear();
+    _root = -1;
+    _aliveNum = 0;
+  }
+
+  // the frontier in ascending order of the first objective
+  void getFront(std::vector<T> &itemVec) {
+    if (_objectiveNum == 2) {
+      for (auto &p : _front)
+        itemVec.push_back(p.second.second);
+      return;
+    }
+    std::vector<int> idVec;
+    collectAlive(_root, idVec);
+    std::sort(idVec.begin(), idVec.end(), [this](int a, int b) {
+      auto &nodeA = _nodeVec[a];
+      auto &nodeB = _nodeVec[b];
+      if (nodeA.objective[0] != nodeB.objective[0])
+        return nodeA.objective[0] < nodeB.objective[0];
+      return nodeA.order < nodeB.order;
+    });
+    for (int id : idVec)
+      itemVec.push_back(_nodeVec[id].item);
+  }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+namespace PERF {
+// hardware counters of perf_event_open around the hot loops of the
+// analyzer, linux only. when the counters cannot be opened the stages are
+// left empty and the reason is reported
+typedef enum {
+  // MultLevelAnalyzer::oneAnalysis
+  ANALYSIS_STAGE,
+  // compReuseVec, called by every transform matrix that is built
+  REUSE_STAGE,
+  // the transform matrices enumerated by generateAllTransformMatrix
+  TRANSFORM_STAGE,
+  STAGE_NUM
+} Stage;
+
+typedef enum {
+  CYCLES,
+  INSTRUCTIONS,
+  CACHE_MISSES,
+  BRANCH_MISSES,
+  EVENT_NUM
+} Event;
+
+// set before the search starts, the counters of a thread are opened by
+// its first Scope
+extern bool enableFlag;
+void enable();
+
+// the counters of the calling thread, false if they cannot be read
+bool readCounter(long long value[EVENT_NUM]);
+void addStage(Stage stage, long long start[EVENT_NUM],
+              long long end[EVENT_NUM]);
+void outputJSON(std::string name);
+
+// counts its lifetime to stage in the calling thread
+class Scope {
+  Stage _stage;
+  bool _runFlag;
+  long long _start[EVENT_NUM];
+
+public:
+  Scope(Stage stage) : _stage(stage), _runFlag(false) {
+    if (enableFlag)
+      _runFlag = readCounter(_start);
+  }
+  ~Scope() {
+    long long end[EVENT_NUM];
+    if (_runFlag && readCounter(end))
+      addStage(_stage, _start, end);
+  }
+};
+} // namespace PERF
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+namespace PROGRESS {
+// a reporter thread prints the work done over the known totals, the
+// evaluations per second and the ETA on stderr every interval seconds. the
+// ETA assumes the groups of every tile combination take equally long
+void start(double interval);
+void stop();
+bool isRunning();
+
+// tile combinations of all the searches, known before they start. a search
+// of the stochastic engines is one tile of its budget of proposals as groups
+void addTileTotal(long long num);
+void startTile();
+// groups of the current tile combination
+void setGroupTotal(long long num);
+void finishGroup(long long num = 1);
+void setBestScore(double score);
+
+// true at most once per interval, for the search thread to write a
+// snapshot of its results
+bool checkSnapshot();
+} // namespace PROGRESS
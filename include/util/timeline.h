@@ -1,195 +1,78 @@
 #pragma once
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/workload.h"
-#include <algorithm>
-#include <assert.h>
-#include <fstream>
-#include <iostream>
+#include "include/util/debug.h"
+#include <cstdint>
+#include <cstdio>
 #include <memory>
 #include <string>
 #include <vector>
 namespace TIMELINE {
 
-struct TimeLine {
-  std::vector<int> _time;
-  std::vector<int> _varCur;
-  std::vector<int> _curInput;
-  std::vector<int> _curWeight;
-  std::vector<int> _curOutput;
-  int PEX;
-  int PEY;
-};
-
+// the operations of one level, every PE in time order. the file holds
+//   char magic[4] "TLB1"
+//   int32 timeDimNum, PEXNum, PEYNum, outputDimNum, inputDimNum, weightDimNum
+//   int64 recordNum[PEXNum * PEYNum], PEX major
+//   the records of the PEs in the same order, each of int32
+//   time[timeDimNum] output[outputDimNum] input[inputDimNum]
+//   weight[weightDimNum]
+// in native byte order. time[i] is row i + 2 of T, the last row is the most
+// significant. the tensors have their coupled dims only
 void getTimeLine(
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
     MAPPING::Transform &T, WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
-    WORKLOAD::Tensor &O);
-bool timeLineGreater(std::shared_ptr<TimeLine> &t1,
-                     std::shared_ptr<TimeLine> &t2);
-class Generator {
-  std::vector<std::shared_ptr<WORKLOAD::Iterator>> &_coupledVarVec;
-  std::vector<std::shared_ptr<TimeLine>> _timeline;
-  std::shared_ptr<WORKLOAD::Iterator> _PEX;
-  std::shared_ptr<WORKLOAD::Iterator> _PEY;
-  MAPPING::Transform &_T;
-  WORKLOAD::Tensor &_I;
-  WORKLOAD::Tensor &_W;
-  WORKLOAD::Tensor &_O;
-  int _count;
-
-public:
-  Generator(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
-            std::shared_ptr<WORKLOAD::Iterator> PEX,
-            std::shared_ptr<WORKLOAD::Iterator> PEY, MAPPING::Transform &T,
-            WORKLOAD::Tensor &I, WORKLOAD::Tensor &W, WORKLOAD::Tensor &O)
-      : _coupledVarVec(coupledVarVec), _PEX(PEX), _PEY(PEY), _T(T), _O(O),
-        _W(W), _I(I), _count(0) {}
-
-  void getNext() {
-    int coupledVarVecNum = _coupledVarVec.size();
-    for (int i = 0; i < coupledVarVecNum; i++) {
-      if (_coupledVarVec[i]->isTop()) {
-        _coupledVarVec[i]->getNext();
-      } else {
-        _coupledVarVec[i]->getNext();
-        break;
-      }
-    }
-  }
-  bool isEnd() {
-    for (auto var : _coupledVarVec) {
-      if (!var->isTop()) {
-        return false;
-      }
-    }
-    return true;
-  }
-  void getCur() {
-    for (auto var : _coupledVarVec) {
-      std::cout << var->getCur() << ' ';
-    }
-    auto vec = _O.getCur();
-    for (auto tmp : vec) {
-      std::cout << tmp << ' ';
-    }
-    std::cout << std::endl;
-  }
-  void generateTimeLine() {
-    std::shared_ptr<TimeLine> curTime = std::make_shared<TimeLine>();
+    WORKLOAD::Tensor &O, std::string name = "timeline.bin", int threadNum = 0);
 
-    for (auto var : _coupledVarVec) {
-      curTime->_varCur.push_back(var->getCur());
-    }
-    int coupledVarVecNum = _coupledVarVec.size();
-    for (int i = 2; i < coupledVarVecNum; i++) {
-      curTime->_time.push_back(getTCur(i));
-    }
-    curTime->_curInput = _I.getCur();
-    curTime->_curOutput = _O.getCur();
-    curTime->_curWeight = _W.getCur();
-    curTime->PEX = _PEX->getCur();
-    curTime->PEY = _PEY->getCur();
-    _timeline.push_back(curTime);
-  }
-  bool isTimeEq(std::vector<int> &curTime, std::vector<int> &other) {
-    static int timeLen = curTime.size();
-    for (int i = 0; i < timeLen; i++) {
-      if (curTime[i] != other[i])
-        return false;
-    }
-    return true;
-  }
-
-  void displayLine(std::shared_ptr<TimeLine> item, std::ofstream &logFile) {
-    logFile << "PEX " << item->PEX << ' ';
-    logFile << "PEY " << item->PEY << ' ';
-    logFile << "O";
-    for (auto o : item->_curOutput) {
-      logFile << "[" + std::to_string(o) + "]";
-    }
-    logFile << " += I";
-    for (auto i : item->_curInput) {
-      logFile << "[" + std::to_string(i) + "]";
-    }
-    logFile << " * W";
-    for (auto w : item->_curWeight) {
-      logFile << "[" + std::to_string(w) + "]";
-    }
-    logFile << ' ';
-  }
-  void displayLine(int pex, int pey, int dim1, int dim2, int dim3,
-                   std::ofstream &ofile) {
-
-    ofile << "PEX " << pex << ' ';
-    ofile << "PEY " << pey << ' ';
-    ofile << "O";
-    for (int i = 0; i < dim1; i++) {
-      ofile << "[  ]";
-    }
-    ofile << " += I";
-    for (int i = 0; i < dim2; i++) {
-      ofile << "[  ]";
-    }
-    ofile << " * W";
-    for (int i = 0; i < dim3; i++) {
-      ofile << "[  ]";
-    }
-    ofile << ' ';
-  }
+// the coupled dims of a tensor as offsets plus coefficients of the iterators
+struct Access {
+  std::vector<int> _baseVec;
+  std::vector<std::vector<std::pair<int, int>>> _coefVec;
+  void bind(WORKLOAD::Tensor &tensor,
+            std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec);
+  void append(std::vector<int> &cur, std::vector<int32_t> &record);
+};
 
-  void generatorSort() {
-    std::ofstream outfile;
-    outfile.open("timeline.txt", std::ios::out);
-    int PEXMAX = _PEX->getSize();
-    int PEYMAX = _PEY->getSize();
-    std::sort(_timeline.begin(), _timeline.end(), timeLineGreater);
-    std::string ret;
-    std::vector<int> curTime = _timeline[0]->_time;
-    curTime[0] = -1;
-    int timeLineLen = _timeline.size();
+// a T of generateTransformMatrix gives every time row one temporal iterator
+// of its own, the PE iterators may be added to the major time row. the
+// points of one PE then come in time order when the own iterators are
+// walked as nested loops, the last row outermost, without any sort. the
+// walk works on copies of the ranges, the PEs are generated in parallel
+class Generator {
+  int _varNum;
+  int _PEXIndex;
+  int _PEYIndex;
+  // the range of every iterator, the edge point included
+  std::vector<int> _lowVec;
+  std::vector<int> _upVec;
+  // the own iterator of every time row from the least significant one
+  std::vector<int> _loopVec;
+  // the iterators of every time row
+  std::vector<std::vector<int>> _timeVarVec;
+  // iterators with an edge and their children in the level, a point with the
+  // parent at the edge needs the child in the edge range
+  struct EdgeChild {
+    int _parent;
+    int _child;
+    int _lowBound;
+    int _upBound;
+  };
+  std::vector<EdgeChild> _edgeChildVec;
+  Access _accessI;
+  Access _accessW;
+  Access _accessO;
 
-    int weightCoupledDimNum = _W.getCoupledDimNum();
-    int outputCoupledDimNum = _O.getCoupledDimNum();
-    int inputCoupledDimNum = _I.getCoupledDimNum();
+  bool checkEdge(std::vector<int> &cur);
+  void writeRecord(std::vector<int> &cur, std::vector<int32_t> &record,
+                   FILE *file);
 
-    for (int i = 0; i < timeLineLen;) {
-      if (isTimeEq(curTime, _timeline[i]->_time)) {
-        for (int j = 0; j < PEXMAX; j++) {
-          for (int k = 0; k < PEYMAX; k++) {
-            if (_timeline[i]->PEX == j && _timeline[i]->PEY == k) {
-              displayLine(_timeline[i], outfile);
-              outfile << "    ";
-              i++;
-            } else {
-              displayLine(j, k, outputCoupledDimNum, inputCoupledDimNum,
-                          weightCoupledDimNum, outfile);
-              outfile << "    ";
-            }
-          }
-          outfile << std::endl;
-        }
-      } else {
-        outfile << std::endl;
-        curTime = _timeline[i]->_time;
-        outfile << std::to_string(_count) + " time\t";
-        _count++;
-        for (auto t : curTime) {
-          outfile << t << ' ';
-        }
-        outfile << std::endl;
-      }
-    }
-    outfile.close();
-  }
-  int getTCur(int row) {
-    int colNumT = _T.getColNum();
-    std::shared_ptr<WORKLOAD::Polynomial> dim =
-        std::make_shared<WORKLOAD::Polynomial>();
-    for (int i = 0; i < colNumT; i++) {
-      if (_T(row, i) == 1)
-        dim = dim + _coupledVarVec[i];
-    }
-    return dim->getCur();
-  }
+public:
+  Generator(std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+            MAPPING::Transform &T, WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
+            WORKLOAD::Tensor &O);
+  int getPEXNum() { return _upVec[_PEXIndex] - _lowVec[_PEXIndex] + 1; }
+  int getPEYNum() { return _upVec[_PEYIndex] - _lowVec[_PEYIndex] + 1; }
+  // writes the records of one PE in time order, returns their number
+  long long generatePE(int pe, FILE *file);
+  void output(std::string name, int threadNum);
 };
-} // namespace TIMELINE
\ No newline at end of file
+} // namespace TIMELINE
@@ -0,0 +1,47 @@
+#pragma once
+// spans of the search in the chrome trace_event format, to be loaded by
+// perfetto or chrome://tracing. only compiled with -DTRACE_ENABLE, see
+// TRACE in the Makefile, otherwise the macros expand to nothing and their
+// arguments are not evaluated
+#ifdef TRACE_ENABLE
+#include <chrono>
+#include <string>
+#include <vector>
+namespace TRACE {
+
+struct Event {
+  const char *name;
+  std::string arg;
+  long long start;
+  long long dur;
+};
+
+// microseconds since the first call
+long long now();
+// every thread appends to its own buffer without locking, the buffer is
+// moved to the trace once when the thread exits
+void record(const char *name, std::string &arg, long long start,
+            long long end);
+void outputJSON(std::string name);
+
+class Span {
+  const char *_name;
+  std::string _arg;
+  long long _start;
+
+public:
+  Span(const char *name, std::string arg = "")
+      : _name(name), _arg(arg), _start(now()) {}
+  ~Span() { record(_name, _arg, _start, now()); }
+};
+} // namespace TRACE
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+// TRACE_SPAN(name) or TRACE_SPAN(name, arg) times the rest of the scope
+#define TRACE_SPAN(...) TRACE::Span TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
+#define TRACE_OUTPUT(name) TRACE::outputJSON(name)
+#else
+#define TRACE_SPAN(...)
+#define TRACE_OUTPUT(name)
+#endif
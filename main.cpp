@@ -6,6 +6,7 @@
 #include "include/datastruct/mapping.h"
 #include "include/datastruct/workload.h"
 #include "include/searchEngine/groupSearchEngine.h"
+#include "include/searchEngine/stochasticSearchEngine.h"
 #include "include/searchEngine/tileSearchEngine.h"
 #include "include/searchEngine/transformSearchEngine.h"
 #include "include/util/config.h"
@@ -26,9 +27,99 @@ long long DSE::GroupSearchEngine::totalCount = 0;
 long long DSE::MultiLevelTransformSearchEngine::_resultCount = 0;
 extern COST::COSTDADA _Cost;
 
-void startSearch(TaskSet &taskset, AcceleratorSet &accSet, Target &target) {
+// the engine searching one task on one accelerator
+void setupTileSearchEngine(DSE::TileSearchEngine &tileSearchEngine,
+                           Task &task, Accelerator &acc, Target &target,
+                           SearchOption &option) {
+  for (auto &p : task._allIteratorCandidate) {
+    for (auto candidate : p.second) {
+      tileSearchEngine.addCancidate(p.first, candidate);
+    }
+  }
+
+  for (auto &p : acc._LVec) {
+    tileSearchEngine.addLevel(p);
+  }
+  tileSearchEngine.setTarget(target);
+  tileSearchEngine.setBeamWidth(option._beamWidth);
+  tileSearchEngine.setWorkerNum(option._threadNum);
+}
+
+// size of the exhaustive search of every task on every accelerator and its
+// runtime projected from the cost of the evaluations timed while sampling,
+// written to dryrun.json. nothing is searched
+void estimateSearch(TaskSet &taskset, AcceleratorSet &accSet, Target &target,
+                    SearchOption &option) {
+  // evaluations timed in every sampled group
+  const int evaluationNum = 16;
+  std::vector<std::vector<DSE::SearchEstimate>> estimateVec;
+  DSE::SearchEstimate totalEstimate;
+  for (auto &task : taskset.taskVec) {
+    estimateVec.emplace_back();
+    for (auto &acc : accSet.acceleratorVec) {
+      DSE::TileSearchEngine tileSearchEngine(
+          task._tensorMap[ARCH::INPUT], task._tensorMap[ARCH::WEIGHT],
+          task._tensorMap[ARCH::OUTPUT], task._coupledVarVec);
+      setupTileSearchEngine(tileSearchEngine, task, acc, target, option);
+      DSE::SearchEstimate estimate;
+      tileSearchEngine.estimate(estimate, option._dryRunSampleNum,
+                                evaluationNum);
+      totalEstimate.merge(estimate);
+      estimateVec.back().push_back(estimate);
+    }
+  }
+
+  std::ofstream ofile;
+  ofile.open("dryrun.json", std::ios::out);
+  ofile << "{\n\"searches\":[\n";
+  for (int taskIndex = 0; taskIndex < estimateVec.size(); taskIndex++) {
+    for (int accIndex = 0; accIndex < estimateVec[taskIndex].size();
+         accIndex++) {
+      auto &estimate = estimateVec[taskIndex][accIndex];
+      std::cout << "task " << taskIndex << " acc " << accIndex << ": tiles "
+                << estimate.tileNum << " (" << estimate.validTileNum
+                << " fit) groups " << estimate.groupNum << " evaluations "
+                << estimate.evaluationNum << " projected "
+                << estimate.compTime() << "s" << std::endl;
+      if (taskIndex != 0 || accIndex != 0)
+        ofile << ",\n";
+      ofile << "{\"task\":" << taskIndex << ",\"acc\":" << accIndex
+            << ",\"tiles\":" << estimate.tileNum
+            << ",\"validTiles\":" << estimate.validTileNum
+            << ",\"groups\":" << estimate.groupNum
+            << ",\"sampledGroups\":" << estimate.sampledGroupNum
+            << ",\"evaluations\":" << estimate.evaluationNum
+            << ",\"transformSeconds\":" << estimate.transformTime
+            << ",\"secondsPerEvaluation\":" << estimate.compEvaluationCost()
+            << ",\"projectedSeconds\":" << estimate.compTime() << "}";
+    }
+  }
+  ofile << "\n],\n";
+  ofile << "\"evaluations\":" << totalEstimate.evaluationNum << ",\n";
+  ofile << "\"projectedSeconds\":" << totalEstimate.compTime() << "\n}\n";
+  ofile.close();
+  std::cout << "total: evaluations " << totalEstimate.evaluationNum
+            << " per evaluation " << totalEstimate.compEvaluationCost()
+            << "s projected " << totalEstimate.compTime() << "s"
+            << std::endl;
+}
+
+void startSearch(TaskSet &taskset, AcceleratorSet &accSet, Target &target,
+                 SearchOption &option) {
   std::vector<DSE::TileSearchEngine> tileSearchEngineVec;
   std::vector<double> accScore(accSet.acceleratorVec.size(), 0);
+  if (option._progressInterval > 0) {
+    for (auto &task : taskset.taskVec) {
+      // a search of the stochastic engines is one tile
+      long long tileNum = 1;
+      if (option._mode == EXHAUSTIVE) {
+        for (auto &p : task._allIteratorCandidate)
+          tileNum *= p.second.size();
+      }
+      PROGRESS::addTileTotal(tileNum * accSet.acceleratorVec.size());
+    }
+    PROGRESS::start(option._progressInterval);
+  }
   int taskIndex = 0;
   for (auto &task : taskset.taskVec) {
     int accIndex = 0;
@@ -39,39 +130,62 @@ void startSearch(TaskSet &taskset, AcceleratorSet &accSet, Target &target) {
 
       auto &tileSearchEngine =
           tileSearchEngineVec[tileSearchEngineVec.size() - 1];
-      for (auto &p : task._allIteratorCandidate) {
-        for (auto candidate : p.second) {
-          tileSearchEngine.addCancidate(p.first, candidate);
-        }
-      }
-
-      for (auto &p : acc._LVec) {
-        tileSearchEngine.addLevel(p);
+      setupTileSearchEngine(tileSearchEngine, task, acc, target, option);
+      if (option._progressInterval > 0)
+        tileSearchEngine.setSnapshot(option._snapshotName, target, 5);
+      if (option._mode == EXHAUSTIVE) {
+        tileSearchEngine.oneSearch();
+      } else if (option._mode == GENETIC) {
+        DSE::GeneticSearchEngine geneticSearchEngine(tileSearchEngine, target,
+                                                     option);
+        geneticSearchEngine.oneSearch();
+      } else {
+        DSE::StochasticSearchEngine stochasticSearchEngine(tileSearchEngine,
+                                                           target, option);
+        stochasticSearchEngine.oneSearch();
       }
-      tileSearchEngine.oneSearch();
       tileSearchEngine.outputTopResult(taskIndex, accIndex, target, 5);
       accScore[accIndex] += tileSearchEngine.getTopScore() * task._ratio;
       accIndex++;
     }
     taskIndex++;
   }
+  PROGRESS::stop();
   std::cout << std::endl;
   std::cout << "accScore:  ";
   for (auto score : accScore) {
     std::cout << score << "\t";
   }
+  // candidates reaching every stage of the search and why the others died
+  FUNNEL::outputJSON("funnel.json");
+  TRACE_OUTPUT("trace.json");
+  MEMORY::outputJSON("memory.json");
+  if (option._perfFlag)
+    PERF::outputJSON("perf.json");
 }
 
-int main() {
+int main(int argc, char **argv) {
+  SearchOption option;
+  parseSearchOption(argc, argv, option);
+  MEMORY::setLimit(option._memLimit);
+  MEMORY::setReportInterval(option._memReportInterval);
+  if (option._perfFlag)
+    PERF::enable();
   TaskSet taskSet;
   AcceleratorSet accSet;
-  defineTaskSet(taskSet);
+  defineTaskSet(taskSet, option._workloadPack, option._autoTileFlag,
+                option._nearDivisorFlag);
   taskSet.check();
   defineAcceleratorSet(accSet);
   accSet.check();
   Target target(accSet);
   defineTarget(target);
+  for (auto &objective : option._paretoObjectiveVec)
+    target.addParetoObjective(objective.first, objective.second);
   target.check();
-  startSearch(taskSet, accSet, target);
+  if (option._dryRunFlag)
+    estimateSearch(taskSet, accSet, target, option);
+  else
+    startSearch(taskSet, accSet, target, option);
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "include/analysis/capacityAnalysis.h"
+namespace CAPACITY {
+long long compRequiredDataSize(std::vector<long long> &dimRange, int dataWidth,
+                               bool doubleBufferFlag) {
+  return std::accumulate(dimRange.begin(), dimRange.end(), 1,
+                         std::multiplies<long long>()) *
+         (long long)(doubleBufferFlag ? 2 : 1) * (double)dataWidth / 8;
+}
+
+void compRequiredDataSize(WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
+                          WORKLOAD::Tensor &O, int dataWidth,
+                          bool doubleBufferFlag,
+                          long long requiredDataSize[3]) {
+  std::vector<long long> dimRange;
+  dimRange = O.getEveryDimRange();
+  requiredDataSize[ARCH::OUTPUT] =
+      compRequiredDataSize(dimRange, dataWidth, doubleBufferFlag);
+  dimRange = I.getEveryDimRange();
+  requiredDataSize[ARCH::INPUT] =
+      compRequiredDataSize(dimRange, dataWidth, doubleBufferFlag);
+  dimRange = W.getEveryDimRange();
+  requiredDataSize[ARCH::WEIGHT] =
+      compRequiredDataSize(dimRange, dataWidth, doubleBufferFlag);
+}
+
+bool checkBufferSize(ARCH::Level &L, long long requiredDataSize[3]) {
+  if (L.checkIfNetworkExtended())
+    return true;
+  if (L.checkIfBufferTotal()) {
+    long long tmp = requiredDataSize[ARCH::INPUT] +
+                    requiredDataSize[ARCH::WEIGHT] +
+                    requiredDataSize[ARCH::OUTPUT];
+    if (!L.checkBufferSize(tmp, ARCH::TOTAL))
+      return false;
+  } else if (L.checkIfBufferInputALL()) {
+    long long tmp = requiredDataSize[ARCH::INPUT] +
+                    requiredDataSize[ARCH::WEIGHT] +
+                    requiredDataSize[ARCH::OUTPUT];
+    if (!L.checkBufferSize(tmp, ARCH::ALLINPUT))
+      return false;
+    if (!L.checkBufferSize(requiredDataSize[ARCH::OUTPUT], ARCH::OUTPUT))
+      return false;
+  } else {
+    if (!L.checkBufferSize(requiredDataSize[ARCH::INPUT], ARCH::INPUT))
+      return false;
+    if (!L.checkBufferSize(requiredDataSize[ARCH::WEIGHT], ARCH::WEIGHT))
+      return false;
+    if (!L.checkBufferSize(requiredDataSize[ARCH::OUTPUT], ARCH::OUTPUT))
+      return false;
+  }
+  return true;
+}
+
+void CapacityChecker::addLevel(
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+    ARCH::Level &L) {
+  _coupledVarVecVec.push_back(coupledVarVec);
+  _allCoupledVarVec.insert(_allCoupledVarVec.end(), coupledVarVec.begin(),
+                           coupledVarVec.end());
+  _LVec.emplace_back(L);
+}
+
+// unlock the iterators of the level and the levels below, the same state
+// MultLevelAnalyzer::compAndCheckRequiredDataSize uses
+bool CapacityChecker::compAndCheckRequiredDataSize(int level) {
+  ARCH::Level &L = _LVec[level];
+  if (L.checkIfNetworkExtended())
+    return true;
+  for (auto var : _allCoupledVarVec) {
+    var->lock();
+  }
+  for (int i = 0; i <= level; i++) {
+    for (auto var : _coupledVarVecVec[i]) {
+      var->unlock();
+    }
+  }
+  long long requiredDataSize[3];
+  compRequiredDataSize(_I, _W, _O, L.getDataWidth(), L.getDoubleBufferFlag(),
+                       requiredDataSize);
+  for (auto var : _allCoupledVarVec) {
+    var->unlock();
+  }
+  return checkBufferSize(L, requiredDataSize);
+}
+
+bool CapacityChecker::checkRequiredDataSize() {
+  int levelNum = _LVec.size();
+  for (int i = 0; i < levelNum; i++) {
+    if (!compAndCheckRequiredDataSize(i))
+      return false;
+  }
+  return true;
+}
+} // namespace CAPACITY
@@ -1,6 +1,7 @@
 #include "include/analysis/costAnalysis.h"
 #include "include/analysis/multiLevelAnalysis.h"
 extern COST::COSTDADA _Cost;
+std::atomic<long long> MultLevelAnalyzer::analysisCount(0);
 void MultLevelAnalyzer::addLevel(
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> coupledVarVec,
     MAPPING::Transform &T, ARCH::Level &L, bool doubleBufferFlag) {
@@ -11,6 +12,7 @@ void MultLevelAnalyzer::addLevel(
   _coupledVarVecVec.push_back(coupledVarVec);
   extendT(coupledVarVec, spatialDimNum, T);
   extendCoupledVar(coupledVarVec, spatialDimNum);
+  addLevelT(T);
   Analyzer analyzer =
       Analyzer(coupledVarVec, T, _I, _W, _O, L, doubleBufferFlag);
   if (!analyzer.constraintCheckAndBuildAnalyzer())
@@ -36,9 +38,19 @@ void MultLevelAnalyzer::addLevel(
   MAPPING::Transform T(coupledVarVec.size());
   extendT(coupledVarVec, spatialDimNum, T);
   extendCoupledVar(coupledVarVec, spatialDimNum);
+  // no T has been checked for this level yet
+  MAPPING::Transform uncheckedT(0);
+  addLevelT(uncheckedT);
+  _validFlags.push_back(false);
+  // after reset the analyzer of this level is kept and only rebound
+  int level = _coupledVarVecVec.size() - 1;
+  if (level < _analyzerSet.size()) {
+    assert(&_analyzerSet[level].getLevel() == &L);
+    _analyzerSet[level].rebind(coupledVarVec, T, doubleBufferFlag);
+    return;
+  }
   Analyzer analyzer =
       Analyzer(coupledVarVec, T, _I, _W, _O, L, doubleBufferFlag);
-  _validFlags.push_back(false);
   if (!_analyzerSet.empty()) {
     if (_analyzerSet[_analyzerSet.size() - 1]
             .getLevel()
@@ -48,6 +60,60 @@ void MultLevelAnalyzer::addLevel(
   _analyzerSet.emplace_back(analyzer);
 }
 
+// unbind the group, the analyzers stay for the next group which has to add
+// the same levels in the same order
+void MultLevelAnalyzer::reset() {
+  _allCoupledVarVec.clear();
+  _coupledVarVecVec.clear();
+  _resultSet.clear();
+  _validFlags.clear();
+  _levelTVec.clear();
+  _TIdMapVec.clear();
+  _levelTIdVec.clear();
+  _subLevelResultCache.clear();
+}
+
+// the analyzers, the T ids and the sub level cache with its results, the
+// tensors the analyzers copy are not counted
+long long MultLevelAnalyzer::compMemoryBytes() {
+  long long bytes =
+      sizeof(MultLevelAnalyzer) + _analyzerSet.capacity() * sizeof(Analyzer);
+  for (auto &TIdMap : _TIdMapVec) {
+    bytes += MEMORY::compMapBytes(TIdMap);
+    for (auto &p : TIdMap)
+      bytes += p.first.capacity() * sizeof(MAPPING::mappingValueType);
+  }
+  for (auto &cache : _subLevelResultCache) {
+    bytes += MEMORY::compMapBytes(cache);
+    for (auto &p : cache) {
+      bytes += p.first.capacity() * sizeof(int);
+      for (auto &range : p.second._tensorDimRange)
+        bytes += sizeof(range) + range.capacity() * sizeof(long long);
+      if (p.second._result)
+        bytes += p.second._result->compMemoryBytes();
+    }
+  }
+  return bytes;
+}
+
+void MultLevelAnalyzer::addLevelT(MAPPING::Transform &T) {
+  _levelTVec.emplace_back(0);
+  _levelTVec.back().deepCopy(T);
+  _TIdMapVec.emplace_back();
+  _levelTIdVec.push_back(0);
+  _subLevelResultCache.emplace_back();
+  setLevelTId(_levelTVec.size() - 1);
+}
+
+void MultLevelAnalyzer::setLevelTId(int level) {
+  auto &TIdMap = _TIdMapVec[level];
+  auto &matrix = *_levelTVec[level].getMatrix();
+  auto it = TIdMap.find(matrix);
+  if (it == TIdMap.end())
+    it = TIdMap.emplace(matrix, TIdMap.size()).first;
+  _levelTIdVec[level] = it->second;
+}
+
 void MultLevelAnalyzer::extendT(
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
     int spatialDimNum, MAPPING::Transform &T) {
@@ -157,12 +223,13 @@ void MultLevelAnalyzer::generateSublevelBaseResult(
              std::shared_ptr<WORKLOAD::Iterator>> &subLevelEdgeMap,
     std::vector<Base> &baseVec) {
   if (subLevelEdgeMap.empty()) {
-    recusiveAnalysis(level - 1);
-    auto subLevelResult = _analyzerSet[level - 1].getResult();
+    // a previous T of this level may have left edge iterators behind
+    _analyzerSet[level].setCurSubCoupledVarVec();
+    auto &subLevel = analyzeSubLevel(level - 1);
+    auto subLevelResult = std::make_shared<AnalyzerResult>(*subLevel._result);
     subLevelResult->occTimes = _analyzerSet[level].getOccTimes();
     subLevelResultVec.push_back(subLevelResult);
-    baseVec.push_back(Base(subLevelResult->delay,
-                           _analyzerSet[level - 1].getTensorDimRange()));
+    baseVec.push_back(Base(subLevelResult->delay, subLevel._tensorDimRange));
   } else {
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> curSubCoupledVarVec;
     for (auto &item : subLevelEdgeMap) {
@@ -176,18 +243,55 @@ void MultLevelAnalyzer::generateSublevelBaseResult(
     int stateNum = state.size();
     int varNum = curSubCoupledVarVec.size();
     for (int i = 0; i < stateNum; i++) {
+      int baseIndex = compBaseIndex(varNum, state, i);
       changeEdgeByState(1, varNum, i, state, curSubCoupledVarVec);
-      recusiveAnalysis(level - 1);
-      auto subLevelResult = _analyzerSet[level - 1].getResult();
+      auto &subLevel = analyzeSubLevel(level - 1);
+      auto subLevelResult =
+          std::make_shared<AnalyzerResult>(*subLevel._result);
       subLevelResult->occTimes = _analyzerSet[level].getOccTimes();
       subLevelResultVec.push_back(subLevelResult);
-      baseVec[compBaseIndex(varNum, state, i)] = Base(
-          subLevelResult->delay, _analyzerSet[level - 1].getTensorDimRange());
+      baseVec[baseIndex] =
+          Base(subLevelResult->delay, subLevel._tensorDimRange);
       changeEdgeByState(0, varNum, i, state, curSubCoupledVarVec);
     }
   }
 }
 
+// edge states which leave the same iterator ranges at and below the sub
+// level share one result, as do evaluations with the same T below the
+// parent. the caller gets it copied so that occTimes, which depends on the
+// parent, is never written to the cached tree
+SubLevelResult &MultLevelAnalyzer::analyzeSubLevel(int level) {
+  std::vector<int> key(_levelTIdVec.begin(), _levelTIdVec.begin() + level + 1);
+  // an edge iterator above the parent changes the ranges of its inner part
+  // on any level below, so every level up to this one is keyed
+  for (int i = 0; i <= level; i++) {
+    for (auto &var : _analyzerSet[i].getCoupledVarVec()) {
+      key.push_back(var->getLowBound());
+      key.push_back(var->getUpBound());
+    }
+    // the iterators of a PE split keep the range they were split with, the
+    // required data sizes follow the unsplit ones into the edge states
+    for (auto &var : _coupledVarVecVec[i]) {
+      key.push_back(var->getLowBound());
+      key.push_back(var->getUpBound());
+    }
+  }
+  auto &levelCache = _subLevelResultCache[level];
+  if (!_subLevelCacheFlag)
+    levelCache.clear();
+  auto it = levelCache.find(key);
+  if (it != levelCache.end())
+    return it->second;
+  recusiveAnalysis(level);
+  if (levelCache.size() >= _subLevelResultCapacity)
+    levelCache.clear();
+  SubLevelResult &subLevel = levelCache[key];
+  subLevel._result = _analyzerSet[level].getResult();
+  subLevel._tensorDimRange = _analyzerSet[level].getTensorDimRange();
+  return subLevel;
+}
+
 // Performing analysis by recursively constructing base volume and base delay, and conducting bottom-up analysis
 void MultLevelAnalyzer::recusiveAnalysis(int level) {
   if (level != 0) {
@@ -200,23 +304,27 @@ void MultLevelAnalyzer::recusiveAnalysis(int level) {
     generateSublevelBaseResult(level, subLevelResultVec, subLevelEdgeMap,
                                baseVec);
     _analyzerSet[level].setBase(baseVec);
+    // the sizes of the current edge state, not of the evaluation before
+    compAndCheckRequiredDataSize(level);
     _analyzerSet[level].oneAnalysis();
     _analyzerSet[level].setSubLevelResultVec(subLevelResultVec);
-    compAndCheckRequiredDataSize(level);
   } else {
 
     std::vector<Base> baseVec;
     baseVec.push_back({_I.getDimNum(), _W.getDimNum(), _O.getDimNum()});
     _analyzerSet[0].setBase(baseVec);
-    _analyzerSet[0].oneAnalysis();
     compAndCheckRequiredDataSize(0);
+    _analyzerSet[0].oneAnalysis();
   }
 }
 
+// _resultSet holds the levels analyzed, all of them or the ones up to the
+// top of a partial analysis
 void MultLevelAnalyzer::compMultiLevelReuslt(
     std::shared_ptr<AnalyzerResult> resultTreeRoot) {
-  compMultiLevelReusltDFS(resultTreeRoot, _analyzerSet.size() - 1);
-  int levelNum = _analyzerSet.size();
+  compMultiLevelReusltDFS(resultTreeRoot, _resultSet.size() - 1,
+                          resultTreeRoot->occTimes);
+  int levelNum = _resultSet.size();
   for (int i = 0; i < levelNum; i++) {
     auto result = _resultSet[i];
     result->compRate = result->compCycle / result->compRate;
@@ -243,19 +351,27 @@ void MultLevelAnalyzer::compMultiLevelReuslt(
   }
 }
 
+// occTimes is the product of the occTimes on the path to node, the nodes
+// keep their own since the sub trees are shared with the cache
 void MultLevelAnalyzer::compMultiLevelReusltDFS(
-    std::shared_ptr<AnalyzerResult> node, int level) {
-  int occTimes = node->occTimes;
+    std::shared_ptr<AnalyzerResult> node, int level, long long occTimes) {
+  long long nodeOccTimes = node->occTimes;
+  node->occTimes = occTimes;
   *_resultSet[level] += *node;
+  node->occTimes = nodeOccTimes;
   for (auto item : node->subLevelResultVec) {
-    item->occTimes *= occTimes;
-    compMultiLevelReusltDFS(item, level - 1);
+    compMultiLevelReusltDFS(item, level - 1, item->occTimes * occTimes);
   }
 }
 
 void MultLevelAnalyzer::oneAnalysis() {
-  if (!constraintCheck())
+  PERF::Scope perfScope(PERF::ANALYSIS_STAGE);
+  FUNNEL::count(FUNNEL::ANALYSIS);
+  if (!constraintCheck()) {
+    FUNNEL::count(FUNNEL::ANALYSIS_FAIL);
     return;
+  }
+  analysisCount++;
   int levelNum = getLevelNum();
   _resultSet.clear();
   for (int i = 0; i < levelNum; i++) {
@@ -271,6 +387,28 @@ void MultLevelAnalyzer::oneAnalysis() {
   // outputCSV();
 }
 
+// analyze the levels up to level as if it were the top, the upper levels
+// are ignored. used to rank partial mappings of the beam search
+bool MultLevelAnalyzer::partialAnalysis(int level) {
+  assert(level < _analyzerSet.size());
+  for (int i = 0; i <= level; i++) {
+    if (!_validFlags[i])
+      return false;
+  }
+  _resultSet.clear();
+  for (int i = 0; i <= level; i++) {
+    _resultSet.push_back(std::make_shared<AnalyzerResult>(AnalyzerResult()));
+  }
+  recusiveAnalysis(level);
+  auto resultTreeRoot = _analyzerSet[level].getResult();
+  resultTreeRoot->occTimes = 1;
+  compMultiLevelReuslt(resultTreeRoot);
+  compEnergy();
+  compArea();
+  compPower();
+  return true;
+}
+
 void MultLevelAnalyzer::outputCSVArrayName(std::string name,
                                            std::ofstream &logFile) {
   logFile << name + "_output,";
@@ -436,7 +574,7 @@ void MultLevelAnalyzer::outputLog(std::ofstream &logFile) {
 
 void MultLevelAnalyzer::compEnergy() {
   // long long totalCycle = _resultSet[level]->delay;
-  int levelNum = _analyzerSet.size();
+  int levelNum = _resultSet.size();
   // ARCH::Level& _L = _analyzerSet[level].getLevel();
 
   // for curlevel and the innermost regfile(if has), so levelNum + 1
@@ -543,7 +681,7 @@ void MultLevelAnalyzer::compEnergy() {
 }
 
 void MultLevelAnalyzer::compArea() {
-  int levelNum = _analyzerSet.size();
+  int levelNum = _resultSet.size();
   for (int i = 0; i < levelNum; i++) {
     ARCH::Level &L = _analyzerSet[i].getLevel();
     _resultSet[i]->bufferArea[ARCH::INPUT] =
@@ -594,7 +732,7 @@ void MultLevelAnalyzer::compArea() {
 }
 
 void MultLevelAnalyzer::compPower() {
-  int levelNum = _analyzerSet.size();
+  int levelNum = _resultSet.size();
   for (int i = 0; i < levelNum; i++) {
     ARCH::Level &L = _analyzerSet[i].getLevel();
     _resultSet[i]->bufferLeakagePower[ARCH::INPUT] =
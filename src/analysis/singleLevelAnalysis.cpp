@@ -644,50 +644,19 @@ bool Analyzer::compAndCheckRequiredDataSize() {
   _tensorDimRange[ARCH::INPUT] = _oriI.getEveryDimRange();
   _tensorDimRange[ARCH::WEIGHT] = _oriW.getEveryDimRange();
   int dataWidth = _L.getDataWidth();
-  _requiredDataSize[ARCH::OUTPUT] =
-      std::accumulate(_tensorDimRange[ARCH::OUTPUT].begin(),
-                      _tensorDimRange[ARCH::OUTPUT].end(), 1,
-                      std::multiplies<long long>()) *
-      (long long)(_doubleBufferFlag ? 2 : 1) * (double)dataWidth / 8;
-  _requiredDataSize[ARCH::INPUT] =
-      std::accumulate(_tensorDimRange[ARCH::INPUT].begin(),
-                      _tensorDimRange[ARCH::INPUT].end(), 1,
-                      std::multiplies<long long>()) *
-      (long long)(_doubleBufferFlag ? 2 : 1) * (double)dataWidth / 8;
-  _requiredDataSize[ARCH::WEIGHT] =
-      std::accumulate(_tensorDimRange[ARCH::WEIGHT].begin(),
-                      _tensorDimRange[ARCH::WEIGHT].end(), 1,
-                      std::multiplies<long long>()) *
-      (long long)(_doubleBufferFlag ? 2 : 1) * (double)dataWidth / 8;
+  _requiredDataSize[ARCH::OUTPUT] = CAPACITY::compRequiredDataSize(
+      _tensorDimRange[ARCH::OUTPUT], dataWidth, _doubleBufferFlag);
+  _requiredDataSize[ARCH::INPUT] = CAPACITY::compRequiredDataSize(
+      _tensorDimRange[ARCH::INPUT], dataWidth, _doubleBufferFlag);
+  _requiredDataSize[ARCH::WEIGHT] = CAPACITY::compRequiredDataSize(
+      _tensorDimRange[ARCH::WEIGHT], dataWidth, _doubleBufferFlag);
   //_requiredDataSize[ARCH::OUTPUT] = _O.getVolumn();
   //_requiredDataSize[ARCH::INPUT] = _I.getVolumn();
   //_requiredDataSize[ARCH::WEIGHT] = _W.getVolumn();
   _L.setFreeBufferCapacity(_requiredDataSize[ARCH::INPUT],
                            _requiredDataSize[ARCH::WEIGHT],
                            _requiredDataSize[ARCH::OUTPUT]);
-  if (_L.checkIfBufferTotal()) {
-    long long tmp = _requiredDataSize[ARCH::INPUT] +
-                    _requiredDataSize[ARCH::WEIGHT] +
-                    _requiredDataSize[ARCH::OUTPUT];
-    if (!_L.checkBufferSize(tmp, ARCH::TOTAL))
-      return false;
-  } else if (_L.checkIfBufferInputALL()) {
-    long long tmp = _requiredDataSize[ARCH::INPUT] +
-                    _requiredDataSize[ARCH::WEIGHT] +
-                    _requiredDataSize[ARCH::OUTPUT];
-    if (!_L.checkBufferSize(tmp, ARCH::ALLINPUT))
-      return false;
-    if (!_L.checkBufferSize(_requiredDataSize[ARCH::OUTPUT], ARCH::OUTPUT))
-      return false;
-  } else {
-    if (!_L.checkBufferSize(_requiredDataSize[ARCH::INPUT], ARCH::INPUT))
-      return false;
-    if (!_L.checkBufferSize(_requiredDataSize[ARCH::WEIGHT], ARCH::WEIGHT))
-      return false;
-    if (!_L.checkBufferSize(_requiredDataSize[ARCH::OUTPUT], ARCH::OUTPUT))
-      return false;
-  }
-  return true;
+  return CAPACITY::checkBufferSize(_L, _requiredDataSize);
 }
 
 int Analyzer::compTotalBandWidth(ARCH::DATATYPE dataType) {
@@ -756,6 +725,7 @@ void Analyzer::changeEdgeByState(
 void Analyzer::setCurSubCoupledVarVec(
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> curSubCoupledVarVec) {
   _curSubCoupledVarVec = curSubCoupledVarVec;
+  _curSubCoupledVarSet.clear();
   for (auto &item : _curSubCoupledVarVec) {
     _curSubCoupledVarSet.insert(item);
   }
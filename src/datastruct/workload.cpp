@@ -102,4 +102,19 @@ void generateEdgeState(
   }
 }
 
-} // namespace WORKLOAD
\ No newline at end of file
+void cloneIterator(
+    std::vector<std::shared_ptr<Iterator>> &varVec,
+    std::vector<std::shared_ptr<Iterator>> &newVarVec,
+    std::map<std::shared_ptr<Iterator>, std::shared_ptr<Iterator>> &varMap) {
+  for (auto &var : varVec) {
+    auto newVar = std::make_shared<Iterator>(*var);
+    varMap[var] = newVar;
+    newVarVec.push_back(newVar);
+  }
+  for (auto &newVar : newVarVec) {
+    auto coupledIterator = newVar->getCoupledIterator();
+    if (coupledIterator != nullptr && varMap.count(coupledIterator))
+      newVar->setCoupledIterator(varMap[coupledIterator]);
+  }
+}
+} // namespace WORKLOAD
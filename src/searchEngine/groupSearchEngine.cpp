@@ -1,4 +1,5 @@
 #include "include/searchEngine/groupSearchEngine.h"
+#include "include/util/progress.h"
 
 namespace DSE {
 
@@ -62,6 +63,18 @@ void GroupSearchEngine::buildCoupleVarVec(
   // recursive termination
   if (levelIndex == _LVec.size()) {
     int levelNum = _LVec.size();
+    if (_estimate != nullptr) {
+      if (_estimateIndex++ % _estimateStride != 0)
+        return;
+      DSE::MultiLevelTransformSearchEngine multiLevelTransformSearchEngine(
+          _I, _W, _O, _analyzerPool);
+      for (int i = 0; i < levelNum; i++)
+        multiLevelTransformSearchEngine.addLevel(coupledVarVecVec[i],
+                                                 _LVec[i]);
+      multiLevelTransformSearchEngine.estimate(*_estimate,
+                                               _estimateEvaluationNum);
+      return;
+    }
     if (logFlag) {
       if (!_firstFlag)
         logFile << ",\n";
@@ -89,8 +102,9 @@ void GroupSearchEngine::buildCoupleVarVec(
     //}
     // std::cout << std::endl;
     totalCount += 1;
-    DSE::MultiLevelTransformSearchEngine multiLevelTransformSearchEngine(_I, _W,
-                                                                         _O);
+    DSE::MultiLevelTransformSearchEngine multiLevelTransformSearchEngine(
+        _I, _W, _O, _analyzerPool);
+    multiLevelTransformSearchEngine.setBeam(_beamWidth, _beamWeightVec);
 
     for (int i = 0; i < levelNum; i++) {
       multiLevelTransformSearchEngine.addLevel(coupledVarVecVec[i], _LVec[i]);
@@ -101,6 +115,9 @@ void GroupSearchEngine::buildCoupleVarVec(
       logFile << "}" << std::endl;
     multiLevelTransformSearchEngine.constructGroupSearchResult(
         _groupSearchResult, coupledVarVecVec);
+    _analyzerPool.updateUsage();
+    MEMORY::tick();
+    PROGRESS::finishGroup();
 
   } else {
     for (auto &group : rootGroup._subGroupVec) {
@@ -130,10 +147,12 @@ void GroupSearchEngine::recusiveCompPerGroupNum(std::vector<int> &perGroupNum,
         varNum < std::max(1, _spatialNumVec[perGroupNum.size()]))
       return;
     perGroupNum.push_back(varNum);
-    for (auto num : perGroupNum) {
-      std::cout << num << ' ';
+    if (_estimate == nullptr) {
+      for (auto num : perGroupNum) {
+        std::cout << num << ' ';
+      }
+      std::cout << std::endl;
     }
-    std::cout << std::endl;
     Group rootGroup;
     std::vector<int> candidate(_varVec.size(), 0);
     std::iota(candidate.begin(), candidate.end(), 0);
@@ -158,11 +177,73 @@ void GroupSearchEngine::recusiveCompPerGroupNum(std::vector<int> &perGroupNum,
   }
 }
 
+// the groups recusiveCompPerGroupNum enumerates, without building them. the
+// levels of perGroupNum pick their iterators out of those left by the levels
+// before, the last level takes the rest
+long long GroupSearchEngine::recusiveCountGroup(std::vector<int> &perGroupNum,
+                                                int varNum, int levelNum) {
+  if (levelNum == 1) {
+    if (perGroupNum.size() != 0 &&
+        varNum < std::max(1, _spatialNumVec[perGroupNum.size()]))
+      return 0;
+    long long count = 1;
+    int restNum = _varVec.size();
+    for (auto num : perGroupNum) {
+      long long combination = 1;
+      for (int i = 1; i <= num; i++)
+        combination = combination * (restNum - num + i) / i;
+      count *= combination;
+      restNum -= num;
+    }
+    return count;
+  }
+  long long count = 0;
+  for (int i = std::max(1, _spatialNumVec[perGroupNum.size()]);
+       i <= varNum - levelNum + 1; i++) {
+    perGroupNum.push_back(i);
+    count += recusiveCountGroup(perGroupNum, varNum - i, levelNum - 1);
+    perGroupNum.pop_back();
+  }
+  return count;
+}
+
+long long GroupSearchEngine::countGroup() {
+  if (_varVec.size() < _LVec.size())
+    return 0;
+  std::vector<int> perGroupNum;
+  return recusiveCountGroup(perGroupNum, _varVec.size(), _LVec.size());
+}
+
+// sample at most sampleNum groups evenly spread over the enumeration order
+// and project what they measure to all countGroup groups
+void GroupSearchEngine::estimate(SearchEstimate &estimate, int sampleNum,
+                                 int evaluationNum) {
+  long long groupNum = countGroup();
+  if (groupNum == 0)
+    return;
+  SearchEstimate sampleEstimate;
+  _estimate = &sampleEstimate;
+  _estimateStride = std::max(1LL, (groupNum + sampleNum - 1) / sampleNum);
+  _estimateIndex = 0;
+  _estimateEvaluationNum = evaluationNum;
+  std::ofstream logFile;
+  oneSearch(logFile, false);
+  _estimate = nullptr;
+
+  double scale = double(groupNum) / sampleEstimate.sampledGroupNum;
+  estimate.groupNum += groupNum;
+  estimate.sampledGroupNum += sampleEstimate.sampledGroupNum;
+  estimate.evaluationNum += sampleEstimate.evaluationNum * scale;
+  estimate.transformTime += sampleEstimate.transformTime * scale;
+  estimate.sampledEvaluationNum += sampleEstimate.sampledEvaluationNum;
+  estimate.sampledEvaluationTime += sampleEstimate.sampledEvaluationTime;
+}
+
 // entry of GroupSearchEngine
 void GroupSearchEngine::oneSearch(std::ofstream &logFile, bool logFlag) {
+  TRACE_SPAN("GroupSearchEngine::oneSearch");
   if (_varVec.size() < _LVec.size())
     return;
-  MultiLevelTransformSearchEngine multiLevelTransformSearchEngine(_I, _W, _O);
   std::vector<int> perGroupNum;
   _firstFlag = true;
   if (logFlag)
@@ -0,0 +1,578 @@
+#include "include/searchEngine/stochasticSearchEngine.h"
+
+namespace DSE {
+MappingEvaluator::MappingEvaluator(TileSearchEngine &tileSearchEngine,
+                                   Target &target)
+    : _tileSearchEngine(tileSearchEngine), _target(target),
+      _evaluationCount(0) {
+  // in the order of the original iterators, not of the iterator addresses,
+  // so a genome means the same on every clone of the engine
+  auto &oriCoupledVarVec = _tileSearchEngine.getOriCoupledVarVec();
+  auto &candidateMap = _tileSearchEngine.getIteratorCandidate();
+  int oriVarNum = oriCoupledVarVec.size();
+  for (int i = 0; i < oriVarNum; i++) {
+    if (candidateMap.count(oriCoupledVarVec[i]) == 0)
+      continue;
+    assert(!candidateMap[oriCoupledVarVec[i]].empty());
+    _tileVarVec.push_back(oriCoupledVarVec[i]);
+    _tileVarIndexVec.push_back(i);
+  }
+  assert(_tileVarVec.size() == candidateMap.size());
+  // the same lower bound the group search puts on every level
+  for (auto &L : _tileSearchEngine.getLevelVec())
+    _minVarNumVec.push_back(std::max(1, L.getSpatialDimNum()));
+}
+
+void MappingEvaluator::randomGenome(MappingGenome &genome, std::mt19937 &rng) {
+  int levelNum = getLevelNum();
+  int partNum = getPartNum();
+  auto &candidateMap = _tileSearchEngine.getIteratorCandidate();
+  genome._tileIndexVec.clear();
+  for (auto &var : _tileVarVec) {
+    std::uniform_int_distribution<int> tileDist(0, candidateMap[var].size() - 1);
+    genome._tileIndexVec.push_back(tileDist(rng));
+  }
+  std::uniform_int_distribution<int> levelDist(0, levelNum - 1);
+  std::uniform_real_distribution<double> keyDist(0, 1);
+  genome._partLevelVec.resize(partNum);
+  genome._partKeyVec.resize(partNum);
+  genome._partLiveVec.assign(partNum, false);
+  for (int i = 0; i < partNum; i++) {
+    genome._partLevelVec[i] = levelDist(rng);
+    genome._partKeyVec[i] = keyDist(rng);
+  }
+  // at most 4 transform matrices per permutation
+  std::uniform_int_distribution<int> TDist(0, 3);
+  genome._TIndexVec.resize(levelNum);
+  for (auto &index : genome._TIndexVec)
+    index = TDist(rng);
+}
+
+// split the iterators, move parts to the levels short of iterators and order
+// every level by the keys. the genome is repaired in place
+bool MappingEvaluator::decode(
+    MappingGenome &genome, std::vector<std::vector<int>> &levelPartVec,
+    std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+        &coupledVarVecVec) {
+  int levelNum = getLevelNum();
+  int oriVarNum = _tileSearchEngine.getOriCoupledVarVec().size();
+  auto &candidateMap = _tileSearchEngine.getIteratorCandidate();
+  auto &coupledVarVec = _tileSearchEngine.getCoupledVarVec();
+  FUNNEL::count(FUNNEL::TILE_COMBINATION);
+  _tileSearchEngine.reset();
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> partVec(oriVarNum * 2);
+  int tileVarNum = _tileVarVec.size();
+  for (int i = 0; i < tileVarNum; i++) {
+    int varNum = coupledVarVec.size();
+    _tileSearchEngine.split(
+        _tileVarVec[i], candidateMap[_tileVarVec[i]][genome._tileIndexVec[i]]);
+    if (coupledVarVec.size() > varNum)
+      partVec[_tileVarIndexVec[i] * 2 + 1] = coupledVarVec.back();
+  }
+  for (int i = 0; i < oriVarNum; i++)
+    partVec[i * 2] = coupledVarVec[i];
+
+  levelPartVec.assign(levelNum, std::vector<int>());
+  for (int i = 0; i < oriVarNum * 2; i++) {
+    genome._partLiveVec[i] = partVec[i] != nullptr;
+    if (partVec[i] != nullptr)
+      levelPartVec[genome._partLevelVec[i]].push_back(i);
+  }
+  for (int i = 0; i < levelNum; i++) {
+    while (levelPartVec[i].size() < _minVarNumVec[i]) {
+      int donor = -1;
+      int donorSurplus = 0;
+      for (int j = 0; j < levelNum; j++) {
+        int surplus = int(levelPartVec[j].size()) - _minVarNumVec[j];
+        if (surplus > donorSurplus) {
+          donor = j;
+          donorSurplus = surplus;
+        }
+      }
+      if (donor == -1)
+        return false;
+      int part = levelPartVec[donor].back();
+      levelPartVec[donor].pop_back();
+      levelPartVec[i].push_back(part);
+      genome._partLevelVec[part] = i;
+    }
+  }
+
+  coupledVarVecVec.clear();
+  for (int i = 0; i < levelNum; i++) {
+    auto &parts = levelPartVec[i];
+    std::sort(parts.begin(), parts.end(), [&](int a, int b) {
+      if (genome._partKeyVec[a] != genome._partKeyVec[b])
+        return genome._partKeyVec[a] < genome._partKeyVec[b];
+      return a < b;
+    });
+    coupledVarVecVec.emplace_back();
+    for (auto part : parts)
+      coupledVarVecVec[i].push_back(partVec[part]);
+  }
+  return true;
+}
+
+int MappingEvaluator::getTransformNum(int dimNum, int spatialDimNum) {
+  std::vector<int> permute(dimNum, 0);
+  std::iota(permute.begin(), permute.end(), 0);
+  std::vector<MAPPING::Transform> TVecTmp;
+  TransformSearchEngine::generateTransformMatrix(dimNum, spatialDimNum,
+                                                 permute, TVecTmp);
+  return TVecTmp.size();
+}
+
+void MappingEvaluator::getMappingKey(
+    MappingGenome &genome, std::vector<std::vector<int>> &levelPartVec,
+    std::vector<int> &mappingKey) {
+  auto &LVec = _tileSearchEngine.getLevelVec();
+  mappingKey = genome._tileIndexVec;
+  int levelNum = getLevelNum();
+  for (int i = 0; i < levelNum; i++) {
+    mappingKey.push_back(-1);
+    mappingKey.insert(mappingKey.end(), levelPartVec[i].begin(),
+                      levelPartVec[i].end());
+    mappingKey.push_back(
+        genome._TIndexVec[i] %
+        getTransformNum(levelPartVec[i].size(), LVec[i].getSpatialDimNum()));
+  }
+}
+
+// the loops in key order with the transform matrix of the genome come first.
+// if they violate a constraint every other choice of the PE loops and
+// transform matrix is tried, permute returns the loop order that is valid
+bool MappingEvaluator::changeLevelT(
+    MultLevelAnalyzer &multanalysis, int level,
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+    int &TIndex, std::vector<int> &permute) {
+  int dimNum = coupledVarVec.size();
+  int spatialDimNum = _tileSearchEngine.getLevelVec()[level].getSpatialDimNum();
+  int PEXNum = spatialDimNum >= 1 ? dimNum : 1;
+  int PEYNum = spatialDimNum == 2 ? dimNum : 1;
+  for (int x = 0; x < PEXNum; x++) {
+    for (int y = 0; y < PEYNum; y++) {
+      if (spatialDimNum == 2 && x == y)
+        continue;
+      permute.clear();
+      if (spatialDimNum >= 1)
+        permute.push_back(x);
+      if (spatialDimNum == 2)
+        permute.push_back(y);
+      for (int i = 0; i < dimNum; i++) {
+        if (std::find(permute.begin(), permute.end(), i) == permute.end())
+          permute.push_back(i);
+      }
+      std::vector<MAPPING::Transform> TVecTmp;
+      TransformSearchEngine::generateTransformMatrix(dimNum, spatialDimNum,
+                                                     permute, TVecTmp);
+      int TNum = TVecTmp.size();
+      for (int i = 0; i < TNum; i++) {
+        int index = (TIndex + i) % TNum;
+        FUNNEL::count(FUNNEL::TRANSFORM);
+        if (multanalysis.changeT(level, coupledVarVec, spatialDimNum,
+                                 TVecTmp[index], true)) {
+          TIndex = index;
+          return true;
+        }
+        FUNNEL::count(multanalysis.getRejectCounter(level));
+      }
+    }
+  }
+  return false;
+}
+
+// repair.permuteVec and repair.TIndexVec return the valid loop order and
+// transform matrix of every level
+std::shared_ptr<GroupSearchResult> MappingEvaluator::analyze(
+    MappingGenome &genome,
+    std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+        &coupledVarVecVec,
+    MappingRepair &repair) {
+  int levelNum = getLevelNum();
+  auto &LVec = _tileSearchEngine.getLevelVec();
+  WORKLOAD::Tensor &I = _tileSearchEngine.getI();
+  WORKLOAD::Tensor &W = _tileSearchEngine.getW();
+  WORKLOAD::Tensor &O = _tileSearchEngine.getO();
+  CAPACITY::CapacityChecker capacityChecker(I, W, O);
+  for (int i = 0; i < levelNum; i++)
+    capacityChecker.addLevel(coupledVarVecVec[i], LVec[i]);
+  FUNNEL::count(FUNNEL::GROUP);
+  if (!capacityChecker.checkRequiredDataSize()) {
+    FUNNEL::count(FUNNEL::GROUP_REJECT_CAPACITY);
+    return nullptr;
+  }
+
+  MultLevelAnalyzer multanalysis(I, W, O);
+  for (int i = 0; i < levelNum; i++)
+    multanalysis.addLevel(coupledVarVecVec[i], LVec[i],
+                          LVec[i].getDoubleBufferFlag());
+  if (!multanalysis.checkRequiredDataSize()) {
+    FUNNEL::count(FUNNEL::GROUP_REJECT_CAPACITY);
+    return nullptr;
+  }
+  repair._permuteVec.assign(levelNum, std::vector<int>());
+  repair._TIndexVec = genome._TIndexVec;
+  for (int i = 0; i < levelNum; i++) {
+    if (!changeLevelT(multanalysis, i, coupledVarVecVec[i],
+                      repair._TIndexVec[i], repair._permuteVec[i]))
+      return nullptr;
+  }
+  multanalysis.oneAnalysis();
+  // the index is given when the result is added, see addStochasticResult
+  std::vector<std::shared_ptr<MultiLevelTransformSearchResult>> mltsResult;
+  multanalysis.constructSearchResult(mltsResult, 0);
+  if (mltsResult.empty())
+    return nullptr;
+  auto result =
+      std::make_shared<GroupSearchResult>(coupledVarVecVec, mltsResult[0]);
+  result->score = TileSearchEngine::compScore(*result, _target);
+  return result;
+}
+
+// write the valid loop order back to the keys of the genome
+void MappingEvaluator::applyRepair(MappingGenome &genome,
+                                   std::vector<std::vector<int>> &levelPartVec,
+                                   MappingRepair &repair) {
+  int levelNum = getLevelNum();
+  genome._TIndexVec = repair._TIndexVec;
+  for (int i = 0; i < levelNum; i++) {
+    std::vector<int> &parts = levelPartVec[i];
+    std::vector<int> &permute = repair._permuteVec[i];
+    std::vector<double> keyVec;
+    for (auto part : parts)
+      keyVec.push_back(genome._partKeyVec[part]);
+    std::vector<int> newParts;
+    for (int j = 0; j < parts.size(); j++) {
+      newParts.push_back(parts[permute[j]]);
+      genome._partKeyVec[newParts[j]] = keyVec[j];
+    }
+    parts = newParts;
+  }
+}
+
+// the repair only depends on the decoded mapping, so a cached mapping
+// repairs the genome the same way as its first analysis
+std::shared_ptr<GroupSearchResult>
+MappingEvaluator::evaluate(MappingGenome &genome, bool &newFlag,
+                           std::vector<int> &mappingKey) {
+  std::vector<std::vector<int>> levelPartVec;
+  std::vector<std::vector<std::shared_ptr<WORKLOAD::Iterator>>>
+      coupledVarVecVec;
+  newFlag = false;
+  mappingKey.clear();
+  if (!decode(genome, levelPartVec, coupledVarVecVec))
+    return nullptr;
+  getMappingKey(genome, levelPartVec, mappingKey);
+  auto it = _cache.find(mappingKey);
+  if (it == _cache.end()) {
+    newFlag = true;
+    _evaluationCount++;
+    auto &entry = _cache[mappingKey];
+    entry.first = analyze(genome, coupledVarVecVec, entry.second);
+    it = _cache.find(mappingKey);
+  }
+  auto result = it->second.first;
+  if (result == nullptr)
+    return result;
+  applyRepair(genome, levelPartVec, it->second.second);
+  getMappingKey(genome, levelPartVec, mappingKey);
+  // the repaired genome may decode to a mapping analyzed before
+  if (!newFlag)
+    return result;
+  it = _cache.find(mappingKey);
+  if (it != _cache.end()) {
+    newFlag = false;
+    return it->second.first;
+  }
+  // the repaired mapping is valid as it is
+  auto &entry = _cache[mappingKey];
+  entry.first = result;
+  entry.second._TIndexVec = genome._TIndexVec;
+  for (auto &parts : levelPartVec) {
+    entry.second._permuteVec.emplace_back(parts.size(), 0);
+    std::iota(entry.second._permuteVec.back().begin(),
+              entry.second._permuteVec.back().end(), 0);
+  }
+  return result;
+}
+
+std::shared_ptr<GroupSearchResult>
+MappingEvaluator::evaluate(MappingGenome &genome, bool &newFlag) {
+  std::vector<int> mappingKey;
+  return evaluate(genome, newFlag, mappingKey);
+}
+
+// change one tile size, move one part to another level, swap two loops of a
+// level (which also swaps PE and time loops) or change the transform matrix
+void MappingEvaluator::mutate(MappingGenome &genome, std::mt19937 &rng) {
+  int levelNum = getLevelNum();
+  int partNum = genome._partLevelVec.size();
+  auto &candidateMap = _tileSearchEngine.getIteratorCandidate();
+  std::vector<int> livePartVec;
+  for (int i = 0; i < partNum; i++) {
+    if (genome._partLiveVec[i])
+      livePartVec.push_back(i);
+  }
+  std::uniform_int_distribution<int> moveDist(0, 3);
+  while (true) {
+    int move = moveDist(rng);
+    if (move == 0) {
+      std::vector<int> tileIndexVec;
+      for (int i = 0; i < _tileVarVec.size(); i++) {
+        if (candidateMap[_tileVarVec[i]].size() > 1)
+          tileIndexVec.push_back(i);
+      }
+      if (tileIndexVec.empty())
+        continue;
+      int i = tileIndexVec[rng() % tileIndexVec.size()];
+      int candidateNum = candidateMap[_tileVarVec[i]].size();
+      genome._tileIndexVec[i] =
+          (genome._tileIndexVec[i] + 1 + rng() % (candidateNum - 1)) %
+          candidateNum;
+      // a new outer part starts at the level of its inner part
+      int part = _tileVarIndexVec[i] * 2;
+      if (!genome._partLiveVec[part + 1])
+        genome._partLevelVec[part + 1] = genome._partLevelVec[part];
+      return;
+    } else if (move == 1) {
+      if (levelNum == 1 || livePartVec.empty())
+        continue;
+      int part = livePartVec[rng() % livePartVec.size()];
+      genome._partLevelVec[part] =
+          (genome._partLevelVec[part] + 1 + rng() % (levelNum - 1)) % levelNum;
+      return;
+    } else if (move == 2) {
+      int level = rng() % levelNum;
+      std::vector<int> levelPartVec;
+      for (auto part : livePartVec) {
+        if (genome._partLevelVec[part] == level)
+          levelPartVec.push_back(part);
+      }
+      if (levelPartVec.size() < 2)
+        continue;
+      int a = rng() % levelPartVec.size();
+      int b =
+          (a + 1 + rng() % (levelPartVec.size() - 1)) % levelPartVec.size();
+      std::swap(genome._partKeyVec[levelPartVec[a]],
+                genome._partKeyVec[levelPartVec[b]]);
+      return;
+    } else {
+      int level = rng() % levelNum;
+      genome._TIndexVec[level] = (genome._TIndexVec[level] + 1 + rng() % 3) % 4;
+      return;
+    }
+  }
+}
+
+// uniform crossover, both parts of an iterator come from the same parent.
+// the level counts are repaired by decode
+void MappingEvaluator::crossover(MappingGenome &genome1,
+                                 MappingGenome &genome2, MappingGenome &child,
+                                 std::mt19937 &rng) {
+  child = genome1;
+  int tileVarNum = _tileVarVec.size();
+  for (int i = 0; i < tileVarNum; i++) {
+    if (rng() % 2)
+      child._tileIndexVec[i] = genome2._tileIndexVec[i];
+  }
+  int partNum = child._partLevelVec.size();
+  for (int i = 0; i < partNum; i += 2) {
+    if (rng() % 2) {
+      for (int j = i; j < i + 2; j++) {
+        child._partLevelVec[j] = genome2._partLevelVec[j];
+        child._partKeyVec[j] = genome2._partKeyVec[j];
+        child._partLiveVec[j] = genome2._partLiveVec[j];
+      }
+    }
+  }
+  int levelNum = getLevelNum();
+  for (int i = 0; i < levelNum; i++) {
+    if (rng() % 2)
+      child._TIndexVec[i] = genome2._TIndexVec[i];
+  }
+}
+
+// results of the stochastic engines are indexed in the order they are added
+static void addStochasticResult(TileSearchEngine &tileSearchEngine,
+                                std::shared_ptr<GroupSearchResult> &result) {
+  result->_multiLevelTransformSearchResult->_index =
+      MultiLevelTransformSearchEngine::_resultCount++;
+  tileSearchEngine.addResult(result);
+}
+
+void StochasticSearchEngine::oneSearch() {
+  // relative score increase accepted with probability 1/e at the start and
+  // the end of the annealing
+  double startTemperature = 0.1;
+  double endTemperature = 0.0001;
+  long long budget = _option._budget;
+  long long proposalCount = 0;
+  MappingGenome curGenome;
+  std::shared_ptr<GroupSearchResult> curResult;
+  std::shared_ptr<GroupSearchResult> bestResult;
+  std::uniform_real_distribution<double> acceptDist(0, 1);
+  bool newFlag;
+  PROGRESS::startTile();
+  PROGRESS::setGroupTotal(budget);
+
+  while (proposalCount < budget) {
+    MappingGenome genome;
+    if (curResult == nullptr || _option._mode == RANDOMSAMPLE) {
+      _evaluator.randomGenome(genome, _rng);
+    } else {
+      genome = curGenome;
+      _evaluator.mutate(genome, _rng);
+    }
+    auto result = _evaluator.evaluate(genome, newFlag);
+    proposalCount++;
+    PROGRESS::finishGroup();
+    _tileSearchEngine.checkSnapshot();
+    if (result == nullptr)
+      continue;
+    if (newFlag)
+      addStochasticResult(_tileSearchEngine, result);
+    if (bestResult == nullptr || result->score < bestResult->score)
+      bestResult = result;
+    if (curResult == nullptr || _option._mode == RANDOMSAMPLE) {
+      curGenome = genome;
+      curResult = result;
+      continue;
+    }
+    double temperature =
+        startTemperature * pow(endTemperature / startTemperature,
+                               double(proposalCount) / budget);
+    double delta = (result->score - curResult->score) /
+                   std::max(std::abs(curResult->score), 1e-9);
+    if (delta <= 0 || acceptDist(_rng) < exp(-delta / temperature)) {
+      curGenome = genome;
+      curResult = result;
+    }
+  }
+  _tileSearchEngine.flushResult();
+  std::cout << "stochastic search: " << proposalCount << " proposals "
+            << _evaluator.getEvaluationCount() << " evaluations";
+  if (bestResult != nullptr)
+    std::cout << " best score " << bestResult->score;
+  std::cout << std::endl;
+}
+GeneticSearchEngine::GeneticSearchEngine(TileSearchEngine &tileSearchEngine,
+                                         Target &target, SearchOption &option)
+    : _tileSearchEngine(tileSearchEngine), _target(target), _option(option),
+      _rng(option._seed) {
+  int threadNum = _option._threadNum;
+  if (threadNum == 0)
+    threadNum = std::thread::hardware_concurrency();
+  threadNum = std::max(1, std::min(threadNum, _option._populationNum));
+  // worker 0 searches on the engine itself, the others on clones
+  _evaluatorVec.push_back(
+      std::make_shared<MappingEvaluator>(_tileSearchEngine, _target));
+  for (int i = 1; i < threadNum; i++) {
+    _tileSearchEngineVec.push_back(_tileSearchEngine.clone());
+    _evaluatorVec.push_back(std::make_shared<MappingEvaluator>(
+        *_tileSearchEngineVec.back(), _target));
+  }
+}
+
+void evaluateIndividualMultiThread(
+    MappingEvaluator &evaluator,
+    std::vector<GeneticSearchEngine::Individual> &individualVec, int step,
+    int stride) {
+  int num = individualVec.size();
+  for (int i = step; i < num; i += stride) {
+    auto &individual = individualVec[i];
+    individual._result = evaluator.evaluate(
+        individual._genome, individual._newFlag, individual._mappingKey);
+  }
+}
+
+// individual i is always evaluated by worker i % threadNum, so the search is
+// reproducible for a given seed and thread num
+void GeneticSearchEngine::evaluate(std::vector<Individual> &individualVec) {
+  int threadNum = _evaluatorVec.size();
+  if (threadNum == 1) {
+    evaluateIndividualMultiThread(*_evaluatorVec[0], individualVec, 0, 1);
+  } else {
+    std::vector<std::thread> threadVec;
+    for (int t = 0; t < threadNum; t++) {
+      threadVec.emplace_back(evaluateIndividualMultiThread,
+                             std::ref(*_evaluatorVec[t]),
+                             std::ref(individualVec), t, threadNum);
+    }
+    for (auto &thread : threadVec)
+      thread.join();
+  }
+  // the workers have separate caches, keep the first result of every mapping
+  for (auto &individual : individualVec) {
+    if (individual._result == nullptr)
+      continue;
+    if (_resultKeySet.count(individual._mappingKey)) {
+      individual._newFlag = false;
+      continue;
+    }
+    _resultKeySet.insert(individual._mappingKey);
+    individual._newFlag = true;
+    addStochasticResult(_tileSearchEngine, individual._result);
+  }
+}
+
+// binary tournament on score
+GeneticSearchEngine::Individual &
+GeneticSearchEngine::select(std::vector<Individual> &population) {
+  auto &a = population[_rng() % population.size()];
+  auto &b = population[_rng() % population.size()];
+  return a._result->score <= b._result->score ? a : b;
+}
+
+void GeneticSearchEngine::oneSearch() {
+  // probability that a child is also mutated
+  double mutationRate = 0.3;
+  int populationNum = _option._populationNum;
+  long long budget = _option._budget;
+  long long proposalCount = 0;
+  MappingEvaluator &evaluator = *_evaluatorVec[0];
+  std::uniform_real_distribution<double> mutationDist(0, 1);
+  std::vector<Individual> population;
+  int generation = 0;
+  PROGRESS::startTile();
+  PROGRESS::setGroupTotal(budget);
+
+  while (proposalCount < budget) {
+    int childNum = std::min((long long)populationNum, budget - proposalCount);
+    std::vector<Individual> children(childNum);
+    for (auto &child : children) {
+      // random individuals until the population is filled with valid ones
+      if (population.size() < 2) {
+        evaluator.randomGenome(child._genome, _rng);
+        continue;
+      }
+      evaluator.crossover(select(population)._genome,
+                          select(population)._genome, child._genome, _rng);
+      if (mutationDist(_rng) < mutationRate)
+        evaluator.mutate(child._genome, _rng);
+    }
+    evaluate(children);
+    proposalCount += childNum;
+    generation++;
+    PROGRESS::finishGroup(childNum);
+    _tileSearchEngine.checkSnapshot();
+
+    // (mu + lambda) selection, invalid children and duplicates are dropped
+    for (auto &child : children) {
+      if (child._result != nullptr && child._newFlag)
+        population.push_back(child);
+    }
+    std::stable_sort(population.begin(), population.end(),
+                     [](const Individual &a, const Individual &b) {
+                       return a._result->score < b._result->score;
+                     });
+    if (population.size() > populationNum)
+      population.resize(populationNum);
+  }
+  _tileSearchEngine.flushResult();
+  std::cout << "genetic search: " << proposalCount << " proposals "
+            << generation << " generations";
+  if (!population.empty())
+    std::cout << " best score " << population[0]._result->score;
+  std::cout << std::endl;
+}
+} // namespace DSE
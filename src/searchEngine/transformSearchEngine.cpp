@@ -1,6 +1,8 @@
 #include "include/searchEngine/transformSearchEngine.h"
 
 namespace DSE {
+TransformThreadStat TransformSearchEngine::threadStat;
+
 void TransformSearchEngine::setMatrixAsOne(int dimNum, MAPPING::Transform &T,
                                            std::vector<int> &permute,
                                            int start) {
@@ -79,36 +81,52 @@ void TransformSearchEngine::generateTransformMatrix(
 }
 
 // generate transform matrices(multi thread version)
+// the worker handles the permutation roots step, step + stride, ...
 void generateAllTransformMatrixMultiThread(MultiThreadArgs args) {
-  args._count = 0;
+  TRACE_SPAN("generateAllTransformMatrix worker",
+             "level " + std::to_string(args._level));
+  auto start = std::chrono::steady_clock::now();
+  PERF::Scope perfScope(PERF::TRANSFORM_STAGE);
   std::vector<MAPPING::Transform> TVecTmp;
-  do {
-    TransformSearchEngine::generateTransformMatrix(args._coupledVarVec.size(),
-                                                   args._spatialDimNum,
-                                                   args._permute, TVecTmp);
-    for (auto &T : TVecTmp) {
-      if (args._multanalysis.changeT(args._level, args._coupledVarVec,
-                                     args._spatialDimNum, T, true)) {
-        args._TVec.push_back(T);
+  for (int i = args._step; i < args._permuteVec.size(); i += args._stride) {
+    auto &permute = args._permuteVec[i];
+    args._countVec[i] = 0;
+    do {
+      TransformSearchEngine::generateTransformMatrix(
+          args._coupledVarVec.size(), args._spatialDimNum, permute, TVecTmp);
+      for (auto &T : TVecTmp) {
+        if (args._multanalysis.changeT(args._level, args._coupledVarVec,
+                                       args._spatialDimNum, T, true)) {
+          args._TVecVec[i].push_back(T);
+        } else {
+          FUNNEL::count(args._multanalysis.getRejectCounter(args._level));
+        }
       }
-    }
-    args._count += TVecTmp.size();
-    TVecTmp.clear();
-  } while (
-      std::next_permutation(args._permute.begin() + 1, args._permute.end()));
+      args._countVec[i] += TVecTmp.size();
+      FUNNEL::count(FUNNEL::TRANSFORM, TVecTmp.size());
+      TVecTmp.clear();
+    } while (std::next_permutation(permute.begin() + 1, permute.end()));
+  }
+  args._busyTimeVec[args._step] = std::chrono::duration<double>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+  timespec cpuTime;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+  args._cpuTimeVec[args._step] = cpuTime.tv_sec + cpuTime.tv_nsec * 1e-9;
 }
 
 // generate all transform matrices
 void TransformSearchEngine::generateAllTransformMatrix(
     int level, MultLevelAnalyzer &multanalysis,
     std::vector<MultLevelAnalyzer> &multanalysisVec) {
+  TRACE_SPAN("generateAllTransformMatrix", "level " + std::to_string(level));
   int dimNum = _coupledVarVec.size();
 
   assert(dimNum != 0);
 
   if (dimNum <= 1) { 
     // no multi thread
-
+    PERF::Scope perfScope(PERF::TRANSFORM_STAGE);
     std::vector<MAPPING::Transform> TVecTmp;
     std::vector<int> permute{0};
     TransformSearchEngine::generateTransformMatrix(dimNum, _spatialDimNum,
@@ -117,15 +135,21 @@ void TransformSearchEngine::generateAllTransformMatrix(
       if (multanalysis.changeT(level, _coupledVarVec, _spatialDimNum, T,
                                true)) {
         _TVec.push_back(T);
+      } else {
+        FUNNEL::count(multanalysis.getRejectCounter(level));
       }
     }
     TransformSearchEngine::totalCount += TVecTmp.size();
+    FUNNEL::count(FUNNEL::TRANSFORM, TVecTmp.size());
   } else {  
-    // multi thread
-    std::vector<MAPPING::Transform> TVecTmp;
+    // multi thread, one pooled analyzer per thread
+    auto start = std::chrono::steady_clock::now();
+    int threadNum = std::min(dimNum, int(multanalysisVec.size()));
+    assert(threadNum > 0);
     std::vector<std::thread> threadVec;
-    std::vector<std::vector<MAPPING::Transform>> _TVecVec(dimNum);
-    std::vector<MultiThreadArgs> argVec;
+    std::vector<double> busyTimeVec(threadNum, 0);
+    std::vector<double> cpuTimeVec(threadNum, 0);
+    std::vector<std::vector<MAPPING::Transform>> TVecVec(dimNum);
     std::vector<std::vector<int>> permuteVec(dimNum);
     std::vector<long long> countVec(dimNum, 0);
 
@@ -138,21 +162,47 @@ void TransformSearchEngine::generateAllTransformMatrix(
         if (permute[j] >= permute[0])
           permute[j]++;
       }
-      argVec.emplace_back(permute, _spatialDimNum, _coupledVarVec, level,
-                          _TVecVec[i], countVec[i], multanalysisVec[i]);
-      threadVec.emplace_back(generateAllTransformMatrixMultiThread, argVec[i]);
     }
-    for (int i = 0; i < dimNum; i++) {
-      threadVec[i].join();
+    auto createStart = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadNum; t++) {
+      MultiThreadArgs args(permuteVec, _spatialDimNum, _coupledVarVec, level,
+                           TVecVec, countVec, multanalysisVec[t], t,
+                           threadNum, busyTimeVec, cpuTimeVec);
+      threadVec.emplace_back(generateAllTransformMatrixMultiThread, args);
+    }
+    auto joinStart = std::chrono::steady_clock::now();
+    for (auto &thread : threadVec) {
+      thread.join();
     }
+    auto joinEnd = std::chrono::steady_clock::now();
 
+    // merge in permutation order so the result does not depend on threadNum
     for (int i = 0; i < dimNum; i++) {
-      TransformSearchEngine::totalCount += argVec[i]._count;
-      for (auto &TVecThread : argVec[i]._TVec) {
+      TransformSearchEngine::totalCount += countVec[i];
+      for (auto &TVecThread : TVecVec[i]) {
         _TVec.push_back(TVecThread);
       }
     }
+    threadStat.callNum++;
+    threadStat.threadNum += threadNum;
+    threadStat.createTime +=
+        std::chrono::duration<double>(joinStart - createStart).count();
+    threadStat.joinTime +=
+        std::chrono::duration<double>(joinEnd - joinStart).count();
+    threadStat.busyTime +=
+        std::accumulate(busyTimeVec.begin(), busyTimeVec.end(), 0.0);
+    threadStat.maxBusyTime +=
+        *std::max_element(busyTimeVec.begin(), busyTimeVec.end());
+    threadStat.cpuTime +=
+        std::accumulate(cpuTimeVec.begin(), cpuTimeVec.end(), 0.0);
+    threadStat.totalTime += std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
   }
+  long long bytes = _TVec.capacity() * sizeof(MAPPING::Transform);
+  for (auto &T : _TVec)
+    bytes += T.compMemoryBytes() - sizeof(MAPPING::Matrix2D);
+  _TVecUsage.set(bytes);
 }
 
 // call the analyzer
@@ -160,6 +210,7 @@ void Generator::startAnalysis(
     MultLevelAnalyzer &multanalysis,
     std::vector<std::shared_ptr<MultiLevelTransformSearchResult>> &mltsResult,
     int count, std::ofstream &logFile, bool logFlag, bool firstFlag) {
+  TRACE_SPAN("Generator::startAnalysis");
   int levelNum = _transformSearchEngineSet.size();
   for (int i = 0; i < levelNum; i++) {
     auto &transformSearchEngine = _transformSearchEngineSet[i];
@@ -181,4 +232,79 @@ void Generator::startAnalysis(
     logFile << "}";
   }
 }
+
+// score of a partial mapping from the result of its top level, the target
+// weights of all levels are put on it. delay if no weight is set
+double MultiLevelTransformSearchEngine::compPartialScore(
+    AnalyzerResult &result) {
+  double score = 0;
+  bool weightFlag = false;
+  int targetNum = _beamWeightVec.size();
+  for (int j = 0; j < targetNum; j++) {
+    if (_beamWeightVec[j] != 0) {
+      score += _beamWeightVec[j] * getTargetValue(result, j);
+      weightFlag = true;
+    }
+  }
+  if (!weightFlag)
+    return result.delay;
+  return score;
+}
+
+// bottom-up beam search. the partial mappings of the levels 0..level are
+// extended by every transform matrix of the next level and only the
+// _beamWidth best of them are kept, the last level is fully analyzed
+void MultiLevelTransformSearchEngine::beamSearch(
+    MultLevelAnalyzer &multanalysis, std::ofstream &logFile, bool logFlag) {
+  int levelNum = _transformSearchEngineSet.size();
+  // T index of every level of a partial mapping
+  std::vector<std::vector<int>> beam(1);
+  for (int level = 0; level < levelNum - 1; level++) {
+    std::vector<std::pair<double, std::vector<int>>> candidateVec;
+    auto &transformSearchEngine = _transformSearchEngineSet[level];
+    int TNum = transformSearchEngine.getTNum();
+    for (auto &partial : beam) {
+      for (int i = 0; i < level; i++) {
+        _transformSearchEngineSet[i].setIndex(partial[i]);
+        _transformSearchEngineSet[i].changeT(i, multanalysis);
+      }
+      for (int t = 0; t < TNum; t++) {
+        transformSearchEngine.setIndex(t);
+        transformSearchEngine.changeT(level, multanalysis);
+        if (!multanalysis.partialAnalysis(level))
+          continue;
+        candidateVec.emplace_back(
+            compPartialScore(*multanalysis.getLevelResult(level)), partial);
+        candidateVec.back().second.push_back(t);
+      }
+    }
+    if (candidateVec.empty())
+      return;
+    std::stable_sort(candidateVec.begin(), candidateVec.end(),
+                     [](const std::pair<double, std::vector<int>> &a,
+                        const std::pair<double, std::vector<int>> &b) {
+                       return a.first < b.first;
+                     });
+    int num = std::min(_beamWidth, int(candidateVec.size()));
+    beam.clear();
+    for (int i = 0; i < num; i++)
+      beam.push_back(candidateVec[i].second);
+  }
+
+  Generator generator(_transformSearchEngineSet);
+  auto &topTransformSearchEngine = _transformSearchEngineSet[levelNum - 1];
+  int TNum = topTransformSearchEngine.getTNum();
+  int count = 0;
+  bool firstFlag = true;
+  for (auto &partial : beam) {
+    for (int i = 0; i < levelNum - 1; i++)
+      _transformSearchEngineSet[i].setIndex(partial[i]);
+    for (int t = 0; t < TNum; t++) {
+      topTransformSearchEngine.setIndex(t);
+      generator.startAnalysis(multanalysis, _mltsResult, count++, logFile,
+                              logFlag, firstFlag);
+      firstFlag = false;
+    }
+  }
+}
 } // namespace DSE
@@ -1,4 +1,6 @@
 #include "include/util/config.h"
+#include <algorithm>
+#include <sstream>
 using namespace WORKLOAD;
 // define tensor task
 void defineTask1(TaskSet &taskset) {
@@ -133,8 +135,142 @@ void defineTask8(TaskSet &taskset) {
   taskset.addTask(task);
 }
 
-// define tensor task set
-void defineTaskSet(TaskSet &taskset) {
+// a batch of 1 is left out, a range 1 iterator only adds a degenerate
+// iterator
+std::vector<std::shared_ptr<Polynomial>>
+batchDim(std::shared_ptr<Polynomial> batch,
+         std::vector<std::shared_ptr<Polynomial>> polyVec) {
+  if (batch)
+    polyVec.insert(polyVec.begin(), batch);
+  return polyVec;
+}
+
+// stride * out + window on new monomials, stride * out would scale the
+// monomial out shares with the output tensor
+std::shared_ptr<Polynomial> stridedDim(int stride,
+                                       std::shared_ptr<Polynomial> out,
+                                       std::shared_ptr<Polynomial> window) {
+  auto outVar = out->getVarVecForVolumn()[0];
+  auto windowVar = window->getVarVecForVolumn()[0];
+  return stride * outVar + windowVar;
+}
+
+// O[b,i,j] = I[b,i,k] * W[b,k,j], a plain gemm for b 1
+void defineBatchedGemmTask(TaskSet &taskset, int b, int m, int n, int k) {
+  Task task;
+  task.defineRatio(1.0);
+  auto batch = b > 1 ? task.defineIterator(b, "b") : nullptr;
+  auto i = task.defineIterator(m, "i");
+  auto j = task.defineIterator(n, "j");
+  auto kk = task.defineIterator(k, "k");
+
+  task.defineTensor(ARCH::INPUT, "I", batchDim(batch, {i, kk}));
+  task.defineTensor(ARCH::WEIGHT, "W", batchDim(batch, {kk, j}));
+  task.defineTensor(ARCH::OUTPUT, "O", batchDim(batch, {i, j}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+// h and w are the output size, the input is read with the stride
+void defineConvTask(TaskSet &taskset, int k, int c, int h, int w, int r,
+                    int s, int n, int stride) {
+  Task task;
+  task.defineRatio(1.0);
+  auto kk = task.defineIterator(k, "k");
+  auto cc = task.defineIterator(c, "c");
+  auto hh = task.defineIterator(h, "h");
+  auto ww = task.defineIterator(w, "w");
+  auto rr = task.defineIterator(r, "r");
+  auto ss = task.defineIterator(s, "s");
+  auto batch = n > 1 ? task.defineIterator(n, "n") : nullptr;
+
+  task.defineTensor(ARCH::INPUT, "I",
+                    batchDim(batch, {cc, stridedDim(stride, hh, rr),
+                                     stridedDim(stride, ww, ss)}));
+  task.defineTensor(ARCH::WEIGHT, "W", {kk, cc, rr, ss});
+  task.defineTensor(ARCH::OUTPUT, "O", batchDim(batch, {kk, hh, ww}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+// every channel has its own filter, W is not coupled to an output channel
+void defineDepthwiseConvTask(TaskSet &taskset, int c, int h, int w, int r,
+                             int s, int n, int stride) {
+  Task task;
+  task.defineRatio(1.0);
+  auto cc = task.defineIterator(c, "c");
+  auto hh = task.defineIterator(h, "h");
+  auto ww = task.defineIterator(w, "w");
+  auto rr = task.defineIterator(r, "r");
+  auto ss = task.defineIterator(s, "s");
+  auto batch = n > 1 ? task.defineIterator(n, "n") : nullptr;
+
+  task.defineTensor(ARCH::INPUT, "I",
+                    batchDim(batch, {cc, stridedDim(stride, hh, rr),
+                                     stridedDim(stride, ww, ss)}));
+  task.defineTensor(ARCH::WEIGHT, "W", {cc, rr, ss});
+  task.defineTensor(ARCH::OUTPUT, "O", batchDim(batch, {cc, hh, ww}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+// 1x1 conv, no filter window
+void definePointwiseConvTask(TaskSet &taskset, int k, int c, int h, int w,
+                             int n) {
+  Task task;
+  task.defineRatio(1.0);
+  auto kk = task.defineIterator(k, "k");
+  auto cc = task.defineIterator(c, "c");
+  auto hh = task.defineIterator(h, "h");
+  auto ww = task.defineIterator(w, "w");
+  auto batch = n > 1 ? task.defineIterator(n, "n") : nullptr;
+
+  task.defineTensor(ARCH::INPUT, "I", batchDim(batch, {cc, hh, ww}));
+  task.defineTensor(ARCH::WEIGHT, "W", {kk, cc});
+  task.defineTensor(ARCH::OUTPUT, "O", batchDim(batch, {kk, hh, ww}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+// S[b,i,j] = Q[b,i,d] * K[b,j,d], the heads are part of the batch
+void defineAttentionQKTask(TaskSet &taskset, int b, int seqLen, int headDim) {
+  Task task;
+  task.defineRatio(1.0);
+  auto batch = b > 1 ? task.defineIterator(b, "b") : nullptr;
+  auto i = task.defineIterator(seqLen, "i");
+  auto j = task.defineIterator(seqLen, "j");
+  auto d = task.defineIterator(headDim, "d");
+
+  task.defineTensor(ARCH::INPUT, "Q", batchDim(batch, {i, d}));
+  task.defineTensor(ARCH::WEIGHT, "K", batchDim(batch, {j, d}));
+  task.defineTensor(ARCH::OUTPUT, "S", batchDim(batch, {i, j}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+// O[b,i,d] = A[b,i,j] * V[b,j,d], the heads are part of the batch
+void defineAttentionAVTask(TaskSet &taskset, int b, int seqLen, int headDim) {
+  Task task;
+  task.defineRatio(1.0);
+  auto batch = b > 1 ? task.defineIterator(b, "b") : nullptr;
+  auto i = task.defineIterator(seqLen, "i");
+  auto j = task.defineIterator(seqLen, "j");
+  auto d = task.defineIterator(headDim, "d");
+
+  task.defineTensor(ARCH::INPUT, "A", batchDim(batch, {i, j}));
+  task.defineTensor(ARCH::WEIGHT, "V", batchDim(batch, {j, d}));
+  task.defineTensor(ARCH::OUTPUT, "O", batchDim(batch, {i, d}));
+
+  task.defineAutoCandidate();
+  taskset.addTask(task);
+}
+
+void defineAlexNetPack(TaskSet &taskset) {
   defineTask1(taskset);
   defineTask2(taskset);
   defineTask3(taskset);
@@ -145,6 +281,79 @@ void defineTaskSet(TaskSet &taskset) {
   defineTask8(taskset);
 }
 
+// bert-base projections and feed forward over 512 tokens, and the per head
+// products of 128 tokens
+void defineGemmPack(TaskSet &taskset) {
+  defineBatchedGemmTask(taskset, 1, 512, 768, 768);
+  defineBatchedGemmTask(taskset, 1, 512, 3072, 768);
+  defineBatchedGemmTask(taskset, 1, 512, 768, 3072);
+  defineBatchedGemmTask(taskset, 12, 128, 128, 64);
+}
+
+// mobilenet-v2 depthwise layers
+void defineDepthwisePack(TaskSet &taskset) {
+  defineDepthwiseConvTask(taskset, 32, 112, 112, 3, 3, 1, 1);
+  defineDepthwiseConvTask(taskset, 96, 56, 56, 3, 3, 1, 2);
+  defineDepthwiseConvTask(taskset, 144, 28, 28, 3, 3, 1, 2);
+  defineDepthwiseConvTask(taskset, 576, 14, 14, 3, 3, 1, 1);
+}
+
+// mobilenet-v2 projection layers
+void definePointwisePack(TaskSet &taskset) {
+  definePointwiseConvTask(taskset, 16, 32, 112, 112, 1);
+  definePointwiseConvTask(taskset, 24, 96, 56, 56, 1);
+  definePointwiseConvTask(taskset, 32, 144, 28, 28, 1);
+  definePointwiseConvTask(taskset, 96, 576, 14, 14, 1);
+}
+
+// bert-base, 12 heads of 64 over 128 and 512 tokens
+void defineAttentionPack(TaskSet &taskset) {
+  defineAttentionQKTask(taskset, 12, 128, 64);
+  defineAttentionAVTask(taskset, 12, 128, 64);
+  defineAttentionQKTask(taskset, 12, 512, 64);
+  defineAttentionAVTask(taskset, 12, 512, 64);
+}
+
+// resnet-50 stem and downsampling 3x3 convs
+void defineStridedPack(TaskSet &taskset) {
+  defineConvTask(taskset, 64, 3, 112, 112, 7, 7, 1, 2);
+  defineConvTask(taskset, 128, 128, 28, 28, 3, 3, 1, 2);
+  defineConvTask(taskset, 256, 256, 14, 14, 3, 3, 1, 2);
+  defineConvTask(taskset, 512, 512, 7, 7, 3, 3, 1, 2);
+}
+
+const std::vector<std::string> workloadPackVec = {
+    "alexnet", "gemm", "depthwise", "pointwise", "attention", "strided", "all"};
+
+bool checkWorkloadPack(std::string workloadPack) {
+  return std::find(workloadPackVec.begin(), workloadPackVec.end(),
+                   workloadPack) != workloadPackVec.end();
+}
+
+// define tensor task set
+void defineTaskSet(TaskSet &taskset, std::string workloadPack,
+                   bool autoTileFlag, bool nearDivisorFlag) {
+  DEBUG::check(checkWorkloadPack(workloadPack), DEBUG::ERROR_OPTION,
+               workloadPack);
+  bool allFlag = workloadPack == "all";
+  if (allFlag || workloadPack == "alexnet")
+    defineAlexNetPack(taskset);
+  if (allFlag || workloadPack == "gemm")
+    defineGemmPack(taskset);
+  if (allFlag || workloadPack == "depthwise")
+    defineDepthwisePack(taskset);
+  if (allFlag || workloadPack == "pointwise")
+    definePointwisePack(taskset);
+  if (allFlag || workloadPack == "attention")
+    defineAttentionPack(taskset);
+  if (allFlag || workloadPack == "strided")
+    defineStridedPack(taskset);
+  if (autoTileFlag) {
+    for (auto &task : taskset.taskVec)
+      task.defineAutoCandidate(nearDivisorFlag);
+  }
+}
+
 // define accelerator
 void defineAccelerator1(AcceleratorSet &accSet, int row, int col) {
   Accelerator acc;
@@ -192,4 +401,118 @@ void defineAcceleratorSet(AcceleratorSet &accSet) {
 // levelindex targetIndex ratio
 // levelindex: define the accelerator level which the desired target parameters
 // belong targetIndex: define the desired target parameters
+// pareto mode: addParetoObjective(levelindex, targetIndex) for every
+// objective, only the non-dominated results are output. --pareto sets them
+// from the command line
+// ex: top delay, energy and area of a two level accelerator
+//   target.addParetoObjective(1, 9);
+//   target.addParetoObjective(1, 10);
+//   target.addParetoObjective(1, 11);
+//   or --pareto=1:9,1:10,1:11
 void defineTarget(Target &target) { target.addTarget(0, 9, 1); }
+
+long long parseIntegerOption(std::string arg, std::string value,
+                             long long minValue, long long maxValue) {
+  long long ret = 0;
+  size_t len = 0;
+  try {
+    ret = std::stoll(value, &len);
+  } catch (std::exception &) {
+    len = 0;
+  }
+  DEBUG::check(len != 0 && len == value.size() && ret >= minValue &&
+                   ret <= maxValue,
+               DEBUG::ERROR_OPTION, arg);
+  return ret;
+}
+
+double parseDoubleOption(std::string arg, std::string value) {
+  double ret = 0;
+  size_t len = 0;
+  try {
+    ret = std::stod(value, &len);
+  } catch (std::exception &) {
+    len = 0;
+  }
+  DEBUG::check(len != 0 && len == value.size(), DEBUG::ERROR_OPTION, arg);
+  return ret;
+}
+
+// --search=exhaustive|anneal|random|genetic --budget=N --seed=N --threads=N
+// --population=N --beam=N
+// --workload=alexnet|gemm|depthwise|pointwise|attention|strided|all
+// --mem-limit=MB --mem-report=seconds --perf --progress=seconds
+// --snapshot=file --dry-run --dry-run-samples=N --auto-tile[=near]
+// --pareto=level:target,level:target[,...]
+void parseSearchOption(int argc, char **argv, SearchOption &option) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    std::string key = arg.substr(0, arg.find('='));
+    std::string value =
+        arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+    if (key == "--search") {
+      if (value == "exhaustive")
+        option._mode = EXHAUSTIVE;
+      else if (value == "anneal")
+        option._mode = ANNEALING;
+      else if (value == "random")
+        option._mode = RANDOMSAMPLE;
+      else if (value == "genetic")
+        option._mode = GENETIC;
+      else
+        DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--budget" && !value.empty()) {
+      option._budget = parseIntegerOption(arg, value, 1, LLONG_MAX);
+    } else if (key == "--seed" && !value.empty()) {
+      option._seed = parseIntegerOption(arg, value, 0, UINT_MAX);
+    } else if (key == "--threads" && !value.empty()) {
+      option._threadNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._threadNum >= 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--population" && !value.empty()) {
+      option._populationNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._populationNum > 1, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--beam" && !value.empty()) {
+      option._beamWidth = parseIntegerOption(arg, value);
+      DEBUG::check(option._beamWidth > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--workload" && !value.empty()) {
+      option._workloadPack = value;
+      DEBUG::check(checkWorkloadPack(value), DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--mem-limit" && !value.empty()) {
+      option._memLimit =
+          parseIntegerOption(arg, value, 1, LLONG_MAX >> 20) * 1024 * 1024;
+    } else if (key == "--mem-report" && !value.empty()) {
+      option._memReportInterval = parseDoubleOption(arg, value);
+      DEBUG::check(option._memReportInterval > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--perf" && value.empty()) {
+      option._perfFlag = true;
+    } else if (key == "--progress" && !value.empty()) {
+      option._progressInterval = parseDoubleOption(arg, value);
+      DEBUG::check(option._progressInterval > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--snapshot" && !value.empty()) {
+      option._snapshotName = value;
+    } else if (key == "--dry-run" && value.empty()) {
+      option._dryRunFlag = true;
+    } else if (key == "--dry-run-samples" && !value.empty()) {
+      option._dryRunSampleNum = parseIntegerOption(arg, value);
+      DEBUG::check(option._dryRunSampleNum > 0, DEBUG::ERROR_OPTION, arg);
+    } else if (key == "--auto-tile" && (value.empty() || value == "near")) {
+      option._autoTileFlag = true;
+      option._nearDivisorFlag = value == "near";
+    } else if (key == "--pareto" && !value.empty()) {
+      option._paretoObjectiveVec.clear();
+      std::stringstream stream(value);
+      std::string objective;
+      while (std::getline(stream, objective, ',')) {
+        size_t pos = objective.find(':');
+        DEBUG::check(pos != std::string::npos, DEBUG::ERROR_OPTION, arg);
+        option._paretoObjectiveVec.emplace_back(
+            parseIntegerOption(arg, objective.substr(0, pos), 0),
+            parseIntegerOption(arg, objective.substr(pos + 1), 0, 11));
+      }
+      DEBUG::check(option._paretoObjectiveVec.size() >= 2, DEBUG::ERROR_OPTION,
+                   arg);
+    } else {
+      DEBUG::check(false, DEBUG::ERROR_OPTION, arg);
+    }
+  }
+}
@@ -68,6 +68,18 @@ void printError(ErrorType errortype, std::string msg) {
     std::cout << "Error!Empty accelerator set:" << msg << std::endl;
     break;
   }
+  case ERROR_OPTION: {
+    std::cout << "Error!Error option:" << msg << std::endl;
+    break;
+  }
+  case MEMORY_LIMIT: {
+    std::cout << "Error!Memory limit exceeded:" << msg << std::endl;
+    break;
+  }
+  case FILE_ERROR: {
+    std::cout << "Error!File error:" << msg << std::endl;
+    break;
+  }
   }
 }
 
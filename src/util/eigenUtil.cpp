@@ -1,6 +1,7 @@
 
 #include "include/datastruct/mapping.h"
 #include "include/util/eigenUtil.h"
+#include <cmath>
 
 void printMatrix(
     Eigen::Matrix<valueType, Eigen::Dynamic, Eigen::Dynamic> matrix) {
@@ -17,8 +18,57 @@ int GCD(int a, int b) {
   return a;
 }
 
+// compATinv for an N x N transform matrix, the matrices have a fixed size
+// and need no heap allocation
+template <int N>
+void compATinvFixed(MAPPING::Transform &T, MAPPING::Access &A,
+                    std::vector<std::vector<int>> &matrix) {
+  auto &Tmatrix = *T.getMatrix();
+  auto &Amatrix = *A.getMatrix();
+  int ARowNum = Amatrix.size() / N;
+  Eigen::Matrix<valueType, N, N, Eigen::RowMajor> TMatrix;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++)
+      TMatrix(i, j) = Tmatrix[i * N + j];
+  }
+  Eigen::Matrix<valueType, Eigen::Dynamic, N, Eigen::RowMajor> AMatrix(
+      ARowNum, N);
+  for (int i = 0; i < ARowNum; i++) {
+    for (int j = 0; j < N; j++)
+      AMatrix(i, j) = Amatrix[i * N + j];
+  }
+  Eigen::Matrix<valueType, Eigen::Dynamic, N, Eigen::RowMajor> eigenmatrix =
+      AMatrix * TMatrix.inverse();
+  int value;
+  for (int i = 0; i < ARowNum; i++) {
+    std::vector<int> tmp(N);
+    for (int j = 0; j < N; j++) {
+      value = std::lround(eigenmatrix(i, j));
+      DEBUG::check(std::abs(value - eigenmatrix(i, j)) < 1e-5,
+                   DEBUG::REUSEVECSOLVEERROR, "compATinv");
+      tmp[j] = value;
+    }
+    matrix.push_back(tmp);
+  }
+}
+
+// the levels of the default search have 7 to 9 coupled iterators after the
+// PE split, the fixed sizes only pay off at 7 and 8, see kernelBenchmark
 void compATinv(MAPPING::Transform &T, MAPPING::Access &A,
                std::vector<std::vector<int>> &matrix) {
+  switch (T.getColNum()) {
+  case 7:
+    return compATinvFixed<7>(T, A, matrix);
+  case 8:
+    return compATinvFixed<8>(T, A, matrix);
+  default:
+    break;
+  }
+  compATinvGeneric(T, A, matrix);
+}
+
+void compATinvGeneric(MAPPING::Transform &T, MAPPING::Access &A,
+                      std::vector<std::vector<int>> &matrix) {
   int TDimNum = T.getColNum();
   int AColNum = A.getColNum();
   int ARowNum = A.getMatrix()->size() / A.getColNum();
@@ -47,8 +97,8 @@ void compATinv(MAPPING::Transform &T, MAPPING::Access &A,
   for (int i = 0; i < eigenmatrix.rows(); i++) {
     tmp.clear();
     for (int j = 0; j < eigenmatrix.cols(); j++) {
-      value = std::floor(eigenmatrix(i, j));
-      DEBUG::check((value - eigenmatrix(i, j)) < 1e-5,
+      value = std::lround(eigenmatrix(i, j));
+      DEBUG::check(std::abs(value - eigenmatrix(i, j)) < 1e-5,
                    DEBUG::REUSEVECSOLVEERROR, "compATinv");
       tmp.push_back(value);
     }
@@ -277,6 +327,7 @@ solvingLinearEquations(std::vector<std::vector<int>> &matrix,
 
 std::shared_ptr<std::vector<std::vector<int>>>
 compReuseVec(MAPPING::Transform &T, MAPPING::Access &A) {
+  PERF::Scope perfScope(PERF::REUSE_STAGE);
   std::vector<std::vector<int>> ATinv;
   compATinv(T, A, ATinv);
   auto reuseVec = solvingLinearEquations(ATinv, 0);
@@ -0,0 +1,62 @@
+#include "include/util/funnel.h"
+#include <mutex>
+namespace FUNNEL {
+
+static std::mutex exitedMutex;
+static Funnel exitedFunnel;
+
+struct LocalFunnel {
+  Funnel funnel;
+  ~LocalFunnel() {
+    std::lock_guard<std::mutex> lock(exitedMutex);
+    exitedFunnel.merge(funnel);
+  }
+};
+static thread_local LocalFunnel localFunnel;
+
+void count(Counter counter, long long num) {
+  localFunnel.funnel.counter[counter] += num;
+}
+
+void addTime(Stage stage, double time) {
+  localFunnel.funnel.time[stage] += time;
+}
+
+void getTotal(Funnel &total) {
+  std::lock_guard<std::mutex> lock(exitedMutex);
+  total = exitedFunnel;
+  total.merge(localFunnel.funnel);
+}
+
+void reset() {
+  std::lock_guard<std::mutex> lock(exitedMutex);
+  exitedFunnel.reset();
+  localFunnel.funnel.reset();
+}
+
+void outputJSON(std::string name) {
+  Funnel total;
+  getTotal(total);
+  long long *c = total.counter;
+  std::ofstream ofile;
+  ofile.open(name, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"tile\":{\"combinations\":" << c[TILE_COMBINATION] << ","
+        << "\"rejectedCapacity\":" << c[TILE_REJECT_CAPACITY] << ","
+        << "\"time\":" << total.time[TILE_STAGE] << "},\n";
+  ofile << "\"group\":{\"produced\":" << c[GROUP] << ","
+        << "\"rejectedCapacity\":" << c[GROUP_REJECT_CAPACITY] << ","
+        << "\"time\":" << total.time[GROUP_STAGE] << "},\n";
+  ofile << "\"transform\":{\"tried\":" << c[TRANSFORM] << ","
+        << "\"rejectedCheck\":" << c[TRANSFORM_REJECT_CHECK] << ","
+        << "\"rejectedPE\":" << c[TRANSFORM_REJECT_PE] << ","
+        << "\"rejectedNetworkReuse\":" << c[TRANSFORM_REJECT_NETWORK_REUSE]
+        << ","
+        << "\"time\":" << total.time[TRANSFORM_STAGE] << "},\n";
+  ofile << "\"analysis\":{\"run\":" << c[ANALYSIS] << ","
+        << "\"failed\":" << c[ANALYSIS_FAIL] << ","
+        << "\"time\":" << total.time[ANALYSIS_STAGE] << "}\n";
+  ofile << "}\n";
+  ofile.close();
+}
+} // namespace FUNNEL
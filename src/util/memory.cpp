@@ -0,0 +1,94 @@
+#include "include/util/memory.h"
+#include "include/util/debug.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sys/resource.h>
+namespace MEMORY {
+
+static const char *categoryName[CATEGORY_NUM] = {"transform", "analyzer",
+                                                 "analyzerResult",
+                                                 "groupResult"};
+static std::atomic<long long> currentBytes[CATEGORY_NUM];
+static std::atomic<long long> peakBytes[CATEGORY_NUM];
+static std::atomic<long long> totalBytes(0);
+static std::atomic<long long> peakTotalBytes(0);
+static long long limitBytes = 0;
+static double reportInterval = 0;
+static std::mutex reportMutex;
+static std::chrono::steady_clock::time_point lastReport =
+    std::chrono::steady_clock::now();
+
+static void updatePeak(std::atomic<long long> &peak, long long bytes) {
+  long long cur = peak.load();
+  while (bytes > cur && !peak.compare_exchange_weak(cur, bytes))
+    ;
+}
+
+void setLimit(long long limit) { limitBytes = limit; }
+
+void setReportInterval(double interval) { reportInterval = interval; }
+
+void add(Category category, long long bytes) {
+  updatePeak(peakBytes[category], currentBytes[category] += bytes);
+  long long total = totalBytes += bytes;
+  updatePeak(peakTotalBytes, total);
+  if (limitBytes > 0 && total > limitBytes) {
+    report();
+    DEBUG::check(false, DEBUG::MEMORY_LIMIT,
+                 std::to_string(total) + " bytes over the limit of " +
+                     std::to_string(limitBytes) + " when adding to " +
+                     categoryName[category]);
+  }
+}
+
+long long getCurrent(Category category) { return currentBytes[category]; }
+
+long long getPeak(Category category) { return peakBytes[category]; }
+
+void tick() {
+  if (reportInterval <= 0)
+    return;
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    if (std::chrono::duration<double>(now - lastReport).count() <
+        reportInterval)
+      return;
+    lastReport = now;
+  }
+  report();
+}
+
+// on stderr so that it does not mix with the results on stdout
+void report() {
+  std::cerr << "memory: total " << totalBytes / 1024 << "KB peak "
+            << peakTotalBytes / 1024 << "KB";
+  for (int i = 0; i < CATEGORY_NUM; i++)
+    std::cerr << "\t" << categoryName[i] << " " << currentBytes[i] / 1024
+              << "KB peak " << peakBytes[i] / 1024 << "KB";
+  std::cerr << std::endl;
+}
+
+void outputJSON(std::string name) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::ofstream ofile;
+  ofile.open(name, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"limit\":" << limitBytes << ",\n";
+  ofile << "\"peakRSSKB\":" << usage.ru_maxrss << ",\n";
+  ofile << "\"total\":{\"current\":" << totalBytes
+        << ",\"peak\":" << peakTotalBytes << "},\n";
+  for (int i = 0; i < CATEGORY_NUM; i++) {
+    ofile << "\"" << categoryName[i] << "\":{\"current\":" << currentBytes[i]
+          << ",\"peak\":" << peakBytes[i] << "}";
+    if (i != CATEGORY_NUM - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "}\n";
+  ofile.close();
+}
+} // namespace MEMORY
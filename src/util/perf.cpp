@@ -0,0 +1,171 @@
+#include "include/util/perf.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+namespace PERF {
+
+bool enableFlag = false;
+
+static const char *stageName[STAGE_NUM] = {"analysis", "reuseVec",
+                                           "transform"};
+static std::mutex perfMutex;
+// stages of the exited threads
+static long long stageTotal[STAGE_NUM][EVENT_NUM];
+static long long stageCallNum[STAGE_NUM];
+static std::atomic<bool> availableFlag(false);
+static std::string unavailableReason;
+
+static void setUnavailable(std::string reason) {
+  std::lock_guard<std::mutex> lock(perfMutex);
+  if (unavailableReason.empty())
+    unavailableReason = reason;
+}
+
+// one counter group per thread, cycles leads and the others are read with it
+struct ThreadCounter {
+  int fd[EVENT_NUM];
+  bool openFlag;
+  bool validFlag;
+  long long total[STAGE_NUM][EVENT_NUM];
+  long long callNum[STAGE_NUM];
+  ThreadCounter() : openFlag(false), validFlag(false) {
+    for (int i = 0; i < EVENT_NUM; i++)
+      fd[i] = -1;
+    for (int i = 0; i < STAGE_NUM; i++) {
+      callNum[i] = 0;
+      for (int j = 0; j < EVENT_NUM; j++)
+        total[i][j] = 0;
+    }
+  }
+  void closeCounter() {
+#ifdef __linux__
+    for (int i = 0; i < EVENT_NUM; i++) {
+      if (fd[i] >= 0)
+        close(fd[i]);
+      fd[i] = -1;
+    }
+#endif
+    validFlag = false;
+  }
+  void openCounter() {
+    openFlag = true;
+#ifdef __linux__
+    static const unsigned long long config[EVENT_NUM] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < EVENT_NUM; i++) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = config[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1,
+                      i == 0 ? -1 : fd[0], 0);
+      if (fd[i] < 0) {
+        setUnavailable(std::string("perf_event_open: ") + strerror(errno));
+        closeCounter();
+        return;
+      }
+    }
+    ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    validFlag = true;
+    availableFlag = true;
+#else
+    setUnavailable("perf_event_open is linux only");
+#endif
+  }
+  bool read(long long value[EVENT_NUM]) {
+    if (!openFlag)
+      openCounter();
+    if (!validFlag)
+      return false;
+#ifdef __linux__
+    struct {
+      unsigned long long nr;
+      unsigned long long value[EVENT_NUM];
+    } group;
+    if (::read(fd[0], &group, sizeof(group)) != sizeof(group) ||
+        group.nr != EVENT_NUM)
+      return false;
+    for (int i = 0; i < EVENT_NUM; i++)
+      value[i] = group.value[i];
+    return true;
+#else
+    return false;
+#endif
+  }
+  ~ThreadCounter() {
+    closeCounter();
+    std::lock_guard<std::mutex> lock(perfMutex);
+    for (int i = 0; i < STAGE_NUM; i++) {
+      stageCallNum[i] += callNum[i];
+      for (int j = 0; j < EVENT_NUM; j++)
+        stageTotal[i][j] += total[i][j];
+    }
+  }
+};
+static thread_local ThreadCounter threadCounter;
+
+void enable() { enableFlag = true; }
+
+bool readCounter(long long value[EVENT_NUM]) {
+  return threadCounter.read(value);
+}
+
+void addStage(Stage stage, long long start[EVENT_NUM],
+              long long end[EVENT_NUM]) {
+  threadCounter.callNum[stage]++;
+  for (int i = 0; i < EVENT_NUM; i++)
+    threadCounter.total[stage][i] += end[i] - start[i];
+}
+
+static double ratio(long long a, long long b) {
+  return b > 0 ? double(a) / b : 0;
+}
+
+// the stages of the exited threads and of the calling thread. the stages
+// nest, the transform matrices enumerated include their reuse vectors
+void outputJSON(std::string name) {
+  std::lock_guard<std::mutex> lock(perfMutex);
+  std::ofstream ofile;
+  ofile.open(name, std::ios::out);
+  ofile << "{\n";
+  ofile << "\"available\":" << (availableFlag ? "true" : "false") << ",\n";
+  ofile << "\"reason\":\"" << unavailableReason << "\",\n";
+  ofile << "\"stages\":{\n";
+  for (int i = 0; i < STAGE_NUM; i++) {
+    long long t[EVENT_NUM];
+    for (int j = 0; j < EVENT_NUM; j++)
+      t[j] = stageTotal[i][j] + threadCounter.total[i][j];
+    long long callNum = stageCallNum[i] + threadCounter.callNum[i];
+    ofile << "\"" << stageName[i] << "\":{\"calls\":" << callNum << ","
+          << "\"cycles\":" << t[CYCLES] << ","
+          << "\"instructions\":" << t[INSTRUCTIONS] << ","
+          << "\"cacheMisses\":" << t[CACHE_MISSES] << ","
+          << "\"branchMisses\":" << t[BRANCH_MISSES] << ","
+          << "\"ipc\":" << ratio(t[INSTRUCTIONS], t[CYCLES]) << ","
+          << "\"cacheMissesPerKiloInstruction\":"
+          << ratio(t[CACHE_MISSES] * 1000, t[INSTRUCTIONS]) << ","
+          << "\"branchMissesPerKiloInstruction\":"
+          << ratio(t[BRANCH_MISSES] * 1000, t[INSTRUCTIONS]) << "}";
+    if (i != STAGE_NUM - 1)
+      ofile << ",";
+    ofile << "\n";
+  }
+  ofile << "}\n}\n";
+  ofile.close();
+}
+} // namespace PERF
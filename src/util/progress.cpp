@@ -0,0 +1,108 @@
+#include "include/util/progress.h"
+#include "include/analysis/multiLevelAnalysis.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+namespace PROGRESS {
+
+static std::atomic<long long> tileTotal(0);
+static std::atomic<long long> tileStarted(0);
+static std::atomic<long long> groupTotal(0);
+static std::atomic<long long> groupDone(0);
+static std::atomic<double> bestScore(0);
+static std::atomic<bool> bestFlag(false);
+static std::atomic<bool> snapshotFlag(false);
+
+static double reportInterval = 0;
+static bool stopFlag = false;
+static std::mutex stopMutex;
+static std::condition_variable stopCondition;
+static std::thread reporter;
+static std::chrono::steady_clock::time_point startTime;
+
+// fraction of the tile combinations done, the current one counts by its
+// groups
+static double compDoneRate() {
+  long long total = tileTotal;
+  if (total == 0)
+    return 0;
+  double done = std::max(0LL, tileStarted - 1);
+  long long groupNum = groupTotal;
+  if (tileStarted > 0 && groupNum > 0)
+    done += double(groupDone) / groupNum;
+  return std::min(1.0, done / total);
+}
+
+static void report() {
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
+  long long evaluationNum = MultLevelAnalyzer::analysisCount;
+  double rate = compDoneRate();
+  std::cerr << "progress: tile " << tileStarted << "/"
+            << tileTotal << " group " << groupDone << "/" << groupTotal
+            << " evaluations " << evaluationNum << " ("
+            << (elapsed > 0 ? evaluationNum / elapsed : 0) << "/s) elapsed "
+            << elapsed << "s";
+  if (rate > 0)
+    std::cerr << " eta " << elapsed * (1 - rate) / rate << "s";
+  if (bestFlag)
+    std::cerr << " best " << bestScore;
+  std::cerr << std::endl;
+}
+
+static void reportLoop() {
+  std::unique_lock<std::mutex> lock(stopMutex);
+  auto interval = std::chrono::duration<double>(reportInterval);
+  while (!stopCondition.wait_for(lock, interval, [] { return stopFlag; })) {
+    report();
+    snapshotFlag = true;
+  }
+}
+
+void start(double interval) {
+  reportInterval = interval;
+  stopFlag = false;
+  startTime = std::chrono::steady_clock::now();
+  reporter = std::thread(reportLoop);
+}
+
+void stop() {
+  if (!reporter.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    stopFlag = true;
+  }
+  stopCondition.notify_all();
+  reporter.join();
+  report();
+}
+
+bool isRunning() { return reporter.joinable(); }
+
+void addTileTotal(long long num) { tileTotal += num; }
+
+void startTile() {
+  tileStarted++;
+  groupTotal = 0;
+  groupDone = 0;
+}
+
+void setGroupTotal(long long num) {
+  groupTotal = num;
+  groupDone = 0;
+}
+
+void finishGroup(long long num) { groupDone += num; }
+
+void setBestScore(double score) {
+  bestScore = score;
+  bestFlag = true;
+}
+
+bool checkSnapshot() { return snapshotFlag.exchange(false); }
+} // namespace PROGRESS
@@ -1,51 +1,243 @@
 #include "include/util/timeline.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 namespace TIMELINE {
-bool timeLineGreater(std::shared_ptr<TimeLine> &t1,
-                     std::shared_ptr<TimeLine> &t2) {
-  for (int i = t1->_time.size() - 1; i >= 0; i--) {
-    if (t1->_time[i] > t2->_time[i])
-      return false;
-    else if (t1->_time[i] < t2->_time[i])
-      return true;
-  }
-  if (t1->PEX > t2->PEX)
-    return false;
-  else if (t1->PEX < t2->PEX)
-    return true;
-  else {
-    if (t1->PEY > t2->PEY)
-      return false;
-    else
-      return true;
+
+void Access::bind(
+    WORKLOAD::Tensor &tensor,
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec) {
+  tensor.bindVar(coupledVarVec);
+  // the iterators are reset, what is left comes from the other levels
+  _baseVec = tensor.getCur();
+  _coefVec.clear();
+  int dimNum = tensor.getDimNum();
+  int varNum = coupledVarVec.size();
+  for (int dim = 0; dim < dimNum; dim++) {
+    if (!tensor.checkDimCoupled(dim))
+      continue;
+    _coefVec.emplace_back();
+    for (int i = 0; i < varNum; i++) {
+      int coef = tensor.lookupVar(coupledVarVec[i], dim);
+      if (coef)
+        _coefVec.back().push_back({i, coef});
+    }
   }
 }
 
-void getTimeLine(
+void Access::append(std::vector<int> &cur, std::vector<int32_t> &record) {
+  int dimNum = _baseVec.size();
+  for (int dim = 0; dim < dimNum; dim++) {
+    int value = _baseVec[dim];
+    for (auto &item : _coefVec[dim])
+      value += item.second * cur[item.first];
+    record.push_back(value);
+  }
+}
+
+Generator::Generator(
     std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
     MAPPING::Transform &T, WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
-    WORKLOAD::Tensor &O) {
-  int colNum = T.getColNum();
-  std::shared_ptr<WORKLOAD::Iterator> PEX;
-  std::shared_ptr<WORKLOAD::Iterator> PEY;
-  I.bindVar(coupledVarVec);
-  O.bindVar(coupledVarVec);
-  W.bindVar(coupledVarVec);
-
-  for (int i = 0; i < colNum; i++) {
-    if (T(0, i) == 1)
-      PEX = coupledVarVec[i];
-    if (T(1, i) == 1)
-      PEY = coupledVarVec[i];
-  }
-  for (auto var : coupledVarVec) {
+    WORKLOAD::Tensor &O)
+    : _varNum(coupledVarVec.size()) {
+  DEBUG::check(T.getColNum() == _varNum && _varNum > 2, DEBUG::TMATRIXERROR,
+               "timeline");
+  // the ranges and the tensor bases are read with the iterators out of the
+  // edge and at 0, the caller's state is put back at the end
+  std::vector<int> curVec;
+  std::vector<std::shared_ptr<WORKLOAD::Iterator>> edgeVarVec;
+  for (auto &var : coupledVarVec) {
+    curVec.push_back(var->getCur());
+    if (var->hasEdge() && var->isEdge()) {
+      edgeVarVec.push_back(var);
+      var->unsetEdge();
+    }
     var->reset();
   }
-  Generator generator(coupledVarVec, PEX, PEY, T, I, W, O);
-  while (!generator.isEnd()) {
-    generator.generateTimeLine();
-    generator.getNext();
+  for (auto &var : coupledVarVec) {
+    bool edgeFlag = var->hasEdge() && !var->islock();
+    _lowVec.push_back(var->getLowBound());
+    _upVec.push_back(var->getUpBound() + edgeFlag);
+  }
+  for (int i = 0; i < _varNum; i++) {
+    auto &var = coupledVarVec[i];
+    if (!var->hasEdge() || var->islock())
+      continue;
+    auto child = var->getCoupledIterator();
+    auto it = std::find(coupledVarVec.begin(), coupledVarVec.end(), child);
+    if (it != coupledVarVec.end())
+      _edgeChildVec.push_back({i, int(it - coupledVarVec.begin()),
+                               child->getEdgeLowBound(),
+                               child->getEdgeUpBound()});
+  }
+
+  std::vector<int> spatialVec;
+  for (int row = 0; row < 2; row++) {
+    int count = 0;
+    for (int i = 0; i < _varNum; i++) {
+      if (T(row, i) != 0) {
+        spatialVec.push_back(i);
+        count++;
+      }
+    }
+    DEBUG::check(count == 1, DEBUG::TMATRIXERROR,
+                 "timeline needs one iterator per spatial row");
+  }
+  _PEXIndex = spatialVec[0];
+  _PEYIndex = spatialVec[1];
+  std::vector<bool> ownFlag(_varNum, false);
+  for (int row = 2; row < _varNum; row++) {
+    _timeVarVec.emplace_back();
+    int own = -1;
+    for (int i = 0; i < _varNum; i++) {
+      if (T(row, i) == 0)
+        continue;
+      DEBUG::check(T(row, i) == 1, DEBUG::TMATRIXERROR, "timeline");
+      _timeVarVec.back().push_back(i);
+      if (i == _PEXIndex || i == _PEYIndex)
+        continue;
+      DEBUG::check(own == -1 && !ownFlag[i], DEBUG::TMATRIXERROR,
+                   "timeline needs one temporal iterator per time row");
+      own = i;
+      ownFlag[i] = true;
+    }
+    DEBUG::check(own != -1, DEBUG::TMATRIXERROR,
+                 "timeline needs one temporal iterator per time row");
+    _loopVec.push_back(own);
+  }
+
+  _accessO.bind(O, coupledVarVec);
+  _accessI.bind(I, coupledVarVec);
+  _accessW.bind(W, coupledVarVec);
+
+  for (auto &var : edgeVarVec)
+    var->setEdge();
+  for (int i = 0; i < _varNum; i++)
+    coupledVarVec[i]->setCur(curVec[i]);
+}
+
+bool Generator::checkEdge(std::vector<int> &cur) {
+  for (auto &edgeChild : _edgeChildVec) {
+    if (cur[edgeChild._parent] == _upVec[edgeChild._parent] &&
+        (cur[edgeChild._child] < edgeChild._lowBound ||
+         cur[edgeChild._child] > edgeChild._upBound))
+      return false;
   }
-  generator.generateTimeLine();
-  generator.generatorSort();
+  return true;
+}
+
+void Generator::writeRecord(std::vector<int> &cur,
+                            std::vector<int32_t> &record, FILE *file) {
+  record.clear();
+  for (auto &varVec : _timeVarVec) {
+    int value = 0;
+    for (auto i : varVec)
+      value += cur[i];
+    record.push_back(value);
+  }
+  _accessO.append(cur, record);
+  _accessI.append(cur, record);
+  _accessW.append(cur, record);
+  fwrite(record.data(), sizeof(int32_t), record.size(), file);
+}
+
+long long Generator::generatePE(int pe, FILE *file) {
+  std::vector<int> cur = _lowVec;
+  cur[_PEXIndex] += pe / getPEYNum();
+  cur[_PEYIndex] += pe % getPEYNum();
+  std::vector<int32_t> record;
+  int loopNum = _loopVec.size();
+  long long count = 0;
+  while (true) {
+    if (checkEdge(cur)) {
+      writeRecord(cur, record, file);
+      count++;
+    }
+    int i = 0;
+    for (; i < loopNum; i++) {
+      int var = _loopVec[i];
+      if (cur[var] < _upVec[var]) {
+        cur[var]++;
+        break;
+      }
+      cur[var] = _lowVec[var];
+    }
+    if (i == loopNum)
+      break;
+  }
+  return count;
+}
+
+// the workers take the PEs one at a time and write them to a temporary file
+// each, which are copied out in PE order behind the record numbers
+void Generator::output(std::string name, int threadNum) {
+  int PENum = getPEXNum() * getPEYNum();
+  if (threadNum == 0)
+    threadNum = std::thread::hardware_concurrency();
+  threadNum = std::max(1, std::min(threadNum, PENum));
+  std::vector<FILE *> tmpFileVec(threadNum);
+  for (auto &tmpFile : tmpFileVec) {
+    tmpFile = std::tmpfile();
+    DEBUG::check(tmpFile != nullptr, DEBUG::FILE_ERROR,
+                 "temporary file of " + name);
+  }
+  std::vector<int64_t> recordNumVec(PENum);
+  std::vector<long long> offsetVec(PENum);
+  std::vector<int> workerVec(PENum);
+  std::atomic<int> nextPE(0);
+  auto work = [&](int worker) {
+    long long offset = 0;
+    for (int pe = nextPE++; pe < PENum; pe = nextPE++) {
+      workerVec[pe] = worker;
+      offsetVec[pe] = offset;
+      recordNumVec[pe] = generatePE(pe, tmpFileVec[worker]);
+      offset = ftell(tmpFileVec[worker]);
+    }
+  };
+  std::vector<std::thread> threadVec;
+  for (int i = 1; i < threadNum; i++)
+    threadVec.emplace_back(work, i);
+  work(0);
+  for (auto &thread : threadVec)
+    thread.join();
+
+  FILE *file = fopen(name.c_str(), "wb");
+  DEBUG::check(file != nullptr, DEBUG::FILE_ERROR, name);
+  int32_t header[6] = {int32_t(_timeVarVec.size()),
+                       getPEXNum(),
+                       getPEYNum(),
+                       int32_t(_accessO._baseVec.size()),
+                       int32_t(_accessI._baseVec.size()),
+                       int32_t(_accessW._baseVec.size())};
+  fwrite("TLB1", 1, 4, file);
+  fwrite(header, sizeof(int32_t), 6, file);
+  fwrite(recordNumVec.data(), sizeof(int64_t), PENum, file);
+  long long recordBytes =
+      sizeof(int32_t) * (header[0] + header[3] + header[4] + header[5]);
+  std::vector<char> buffer(1 << 16);
+  for (int pe = 0; pe < PENum; pe++) {
+    FILE *tmpFile = tmpFileVec[workerVec[pe]];
+    fseek(tmpFile, offsetVec[pe], SEEK_SET);
+    long long bytes = recordNumVec[pe] * recordBytes;
+    while (bytes > 0) {
+      size_t len = fread(buffer.data(), 1,
+                         std::min<long long>(bytes, buffer.size()), tmpFile);
+      if (len == 0)
+        break;
+      fwrite(buffer.data(), 1, len, file);
+      bytes -= len;
+    }
+  }
+  fclose(file);
+  for (auto tmpFile : tmpFileVec)
+    fclose(tmpFile);
+}
+
+void getTimeLine(
+    std::vector<std::shared_ptr<WORKLOAD::Iterator>> &coupledVarVec,
+    MAPPING::Transform &T, WORKLOAD::Tensor &I, WORKLOAD::Tensor &W,
+    WORKLOAD::Tensor &O, std::string name, int threadNum) {
+  Generator generator(coupledVarVec, T, I, W, O);
+  generator.output(name, threadNum);
 }
-} // namespace TIMELINE
\ No newline at end of file
+} // namespace TIMELINE
@@ -0,0 +1,78 @@
+#include "include/util/trace.h"
+#ifdef TRACE_ENABLE
+#include <atomic>
+#include <fstream>
+#include <mutex>
+namespace TRACE {
+
+static std::mutex traceMutex;
+// events of the exited threads and their thread ids
+static std::vector<std::pair<int, std::vector<Event>>> exitedEventVec;
+static std::atomic<int> threadCount(0);
+
+struct ThreadBuffer {
+  int tid;
+  std::vector<Event> eventVec;
+  ThreadBuffer() : tid(threadCount++) {}
+  ~ThreadBuffer() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    exitedEventVec.emplace_back(tid, std::move(eventVec));
+  }
+};
+static thread_local ThreadBuffer threadBuffer;
+
+long long now() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - epoch)
+      .count();
+}
+
+void record(const char *name, std::string &arg, long long start,
+            long long end) {
+  threadBuffer.eventVec.push_back({name, arg, start, end - start});
+}
+
+static void outputEscaped(std::ofstream &ofile, std::string &s) {
+  for (auto ch : s) {
+    if (ch == '"' || ch == '\\')
+      ofile << '\\';
+    ofile << ch;
+  }
+}
+
+static void outputEvent(std::ofstream &ofile, int tid, Event &event,
+                        bool &firstFlag) {
+  if (!firstFlag)
+    ofile << ",\n";
+  firstFlag = false;
+  ofile << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,"
+        << "\"tid\":" << tid << ",\"ts\":" << event.start
+        << ",\"dur\":" << event.dur;
+  if (!event.arg.empty()) {
+    ofile << ",\"args\":{\"detail\":\"";
+    outputEscaped(ofile, event.arg);
+    ofile << "\"}";
+  }
+  ofile << "}";
+}
+
+// the events of the exited threads and of the calling thread, the others
+// are still running and are left out
+void outputJSON(std::string name) {
+  std::lock_guard<std::mutex> lock(traceMutex);
+  std::ofstream ofile;
+  ofile.open(name, std::ios::out);
+  ofile << "{\"traceEvents\":[\n";
+  bool firstFlag = true;
+  for (auto &p : exitedEventVec) {
+    for (auto &event : p.second)
+      outputEvent(ofile, p.first, event, firstFlag);
+  }
+  for (auto &event : threadBuffer.eventVec)
+    outputEvent(ofile, threadBuffer.tid, event, firstFlag);
+  ofile << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  ofile.close();
+}
+} // namespace TRACE
+#endif